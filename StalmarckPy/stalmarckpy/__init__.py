@@ -2,7 +2,9 @@
 StalmarckPy - Python bindings for the StalmarckSAT solver
 """
 
-from ._stalmarckpy import solve_file
+from ._stalmarckpy import Formula, Solver, SolveStatus, solve_file
+
+__all__ = ["Formula", "Solver", "SolveStatus", "solve", "solve_file"]
 
 def solve(cnf_path):
     """
@@ -14,4 +16,4 @@ def solve(cnf_path):
     Returns:
         bool: True if the formula is satisfiable, False otherwise
     """
-    return solve_file(cnf_path)
\ No newline at end of file
+    return solve_file(cnf_path)
@@ -1,28 +1,197 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
 #include "../src/core/stalmarck.hpp"
-#include "../src/core/formula_impl.hpp"  // Include the formula implementation
+#include "../src/core/formula.hpp"
+#include "../src/parser/parser.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
 #include <stdexcept>
+#include <vector>
 
 namespace py = pybind11;
 
+static_assert(sizeof(int) == sizeof(int32_t), "literals are passed as int32");
+
+using IntArray = py::array_t<int32_t, py::array::c_style | py::array::forcecast>;
+
+namespace {
+
 bool solve_file(const std::string& cnf_path) {
-    try {
-        stalmarck::StalmarckSolver solver;
-        bool success = solver.solve(cnf_path);
-        
-        if (!success) {
-            throw std::runtime_error("Error during solving");
+    stalmarck::StalmarckSolver solver;
+    bool success;
+    {
+        py::gil_scoped_release release;
+        success = solver.solve(cnf_path);
+    }
+
+    if (!success) {
+        throw std::runtime_error("Error: could not read " + cnf_path);
+    }
+
+    // Same meaning as the CLI: true for SAT, false for UNSAT
+    return solver.get_status() == stalmarck::SolveStatus::SAT;
+}
+
+// Build a Formula from a flat DIMACS-style array: clauses separated by 0
+stalmarck::Formula formula_from_array(const IntArray& literals) {
+    if (literals.ndim() != 1) {
+        throw std::invalid_argument("literals must be a one-dimensional array");
+    }
+    stalmarck::Formula formula;
+    formula.add_clauses(literals.data(), static_cast<size_t>(literals.size()));
+    return formula;
+}
+
+// Build a Formula from a flat literal array plus clause start offsets
+// (CSR layout, len(offsets) == num_clauses + 1)
+stalmarck::Formula formula_from_csr(const IntArray& literals, const IntArray& offsets) {
+    if (literals.ndim() != 1 || offsets.ndim() != 1 || offsets.size() < 1) {
+        throw std::invalid_argument("literals and offsets must be one-dimensional");
+    }
+    const int32_t* lits = literals.data();
+    const int32_t* offs = offsets.data();
+    stalmarck::Formula formula;
+    std::vector<int> clause;
+    for (py::ssize_t c = 0; c + 1 < offsets.size(); ++c) {
+        if (offs[c] < 0 || offs[c] > offs[c + 1] || offs[c + 1] > literals.size()) {
+            throw std::invalid_argument("offsets must be non-decreasing and within literals");
+        }
+        clause.assign(lits + offs[c], lits + offs[c + 1]);
+        formula.add_clause(clause);
+    }
+    return formula;
+}
+
+// Build a Formula from an infix propositional formula; negate asserts it
+// false, so that UNSAT means it is a tautology
+stalmarck::Formula formula_from_expression(const std::string& text, bool negate) {
+    stalmarck::Parser parser;
+    stalmarck::Formula formula = parser.parse_expression_string(text, negate);
+    if (parser.has_error()) {
+        throw std::invalid_argument(parser.get_error());
+    }
+    return formula;
+}
+
+py::dict stats_to_dict(const stalmarck::SolverStats& stats) {
+    py::dict d;
+    d["decisions"] = stats.decisions;
+    d["propagations"] = stats.propagations;
+    d["conflicts"] = stats.conflicts;
+    d["failed_literals"] = stats.failed_literals;
+    d["substituted_variables"] = stats.substituted_variables;
+    d["xor_propagations"] = stats.xor_propagations;
+    d["solve_time"] = stats.solve_time;
+    return d;
+}
+
+// Formulas with a solve running, and how many. Only touched with the GIL
+// held, which is what serialises it
+std::unordered_map<const stalmarck::Formula*, int> solving;
+
+// Marks a formula as being solved for the lifetime of the guard
+class SolvingGuard {
+public:
+    explicit SolvingGuard(const stalmarck::Formula& formula) : formula_(&formula) {
+        solving[formula_]++;
+    }
+    ~SolvingGuard() {
+        if (--solving[formula_] == 0) {
+            solving.erase(formula_);
         }
-        
-        return !solver.is_tautology(); // Return true for SAT, false for UNSAT
-    } catch (const std::exception& e) {
-        throw std::runtime_error(std::string("Error: ") + e.what());
+    }
+    SolvingGuard(const SolvingGuard&) = delete;
+    SolvingGuard& operator=(const SolvingGuard&) = delete;
+
+private:
+    const stalmarck::Formula* formula_;
+};
+
+// Solves read the formula without the GIL, so it must not change under them
+void check_not_solving(const stalmarck::Formula& formula) {
+    if (solving.count(&formula) != 0) {
+        throw std::runtime_error("cannot modify a Formula while a solve is using it");
     }
 }
 
+// Solve with the GIL released so Python threads can run solves concurrently.
+// Encoding happens there too: get_triplets() is safe from several threads.
+// The guard is released after the GIL is taken back
+stalmarck::SolveStatus solve_formula(stalmarck::StalmarckSolver& solver,
+                                     const stalmarck::Formula& formula,
+                                     const IntArray& assumptions) {
+    std::vector<int> assumed(assumptions.data(), assumptions.data() + assumptions.size());
+
+    SolvingGuard guard(formula);
+    py::gil_scoped_release release;
+    solver.solve(formula, assumed);
+    return solver.get_status();
+}
+
+} // namespace
+
 PYBIND11_MODULE(_stalmarckpy, m) {
     m.doc() = "Python bindings for StalmarckSAT solver";
-    
-    m.def("solve_file", &solve_file, "Solve a CNF formula from a file",
+
+    m.def("solve_file", &solve_file, "Solve a CNF formula from a file; True if satisfiable",
           py::arg("cnf_path"));
-}
\ No newline at end of file
+
+    py::enum_<stalmarck::SolveStatus>(m, "SolveStatus")
+        .value("SAT", stalmarck::SolveStatus::SAT)
+        .value("UNSAT", stalmarck::SolveStatus::UNSAT)
+        .value("UNKNOWN", stalmarck::SolveStatus::UNKNOWN);
+
+    py::class_<stalmarck::Formula>(m, "Formula")
+        .def(py::init<>())
+        .def_static("from_array", &formula_from_array,
+                    "Build from an int32 array of 0-terminated clauses", py::arg("literals"))
+        .def_static("from_csr", &formula_from_csr,
+                    "Build from int32 literals and clause offsets", py::arg("literals"), py::arg("offsets"))
+        .def_static("from_expression", &formula_from_expression,
+                    "Build from an infix formula such as \"(p -> q) & p -> q\"; negate for tautology checks",
+                    py::arg("text"), py::arg("negate") = false)
+        .def("add_clause", [](stalmarck::Formula& formula, const std::vector<int>& literals) {
+                check_not_solving(formula);
+                formula.add_clause(literals);
+            }, py::arg("literals"))
+        .def("add_clauses", [](stalmarck::Formula& formula, const IntArray& literals) {
+                check_not_solving(formula);
+                formula.add_clauses(literals.data(), static_cast<size_t>(literals.size()));
+            }, "Append an int32 array of 0-terminated clauses", py::arg("literals"))
+        .def("add_xor", [](stalmarck::Formula& formula, const std::vector<int>& literals) {
+                check_not_solving(formula);
+                formula.add_xor(literals);
+            }, "Require the XOR of these literals to be true", py::arg("literals"))
+        .def_property_readonly("num_variables", &stalmarck::Formula::num_variables)
+        .def_property_readonly("num_clauses", &stalmarck::Formula::num_clauses);
+
+    py::class_<stalmarck::StalmarckSolver>(m, "Solver")
+        .def(py::init<>())
+        .def("set_timeout", &stalmarck::StalmarckSolver::set_timeout, py::arg("seconds"))
+        .def("set_lookahead", &stalmarck::StalmarckSolver::set_lookahead,
+             "Choose splits by probing candidate variables; 0 turns it off",
+             py::arg("candidates"), py::arg("threads") = 1)
+        .def("set_inprocessing", &stalmarck::StalmarckSolver::set_inprocessing,
+             "Simplify during search, spending at most `effort` of the search time",
+             py::arg("enabled"), py::arg("effort") = 0.1)
+        .def("set_compact", &stalmarck::StalmarckSolver::set_compact,
+             "Keep assignments at two bits per variable", py::arg("enabled"))
+        .def("set_local_search", &stalmarck::StalmarckSolver::set_local_search,
+             "Run local search for up to `seconds` before the complete search; 0 turns it off",
+             py::arg("seconds"))
+        .def("solve", &solve_formula,
+             "Solve under optional assumptions; releases the GIL while searching",
+             py::arg("formula"), py::arg("assumptions") = IntArray(0))
+        .def_property_readonly("status", &stalmarck::StalmarckSolver::get_status)
+        .def_property_readonly("model", [](const stalmarck::StalmarckSolver& solver) {
+                const std::vector<int>& model = solver.get_model();
+                IntArray result(static_cast<py::ssize_t>(model.size()));
+                std::copy(model.begin(), model.end(), result.mutable_data());
+                return result;
+            }, "Signed literals for variables 1..n, as an int32 array")
+        .def_property_readonly("stats", [](const stalmarck::StalmarckSolver& solver) {
+                return stats_to_dict(solver.get_stats());
+            });
+}
@@ -1,18 +1,121 @@
 #!/usr/bin/env python
-from stalmarckpy import solve
 import sys
+import threading
+import time
+import unittest
+
+import numpy as np
+from stalmarckpy import Formula, Solver, SolveStatus, solve
+
+# Exactly one of x1, x2, x3, as 0-terminated clauses and in CSR form
+EXACTLY_ONE = [1, 2, 3, 0, -1, -2, 0, -2, -3, 0, -1, -3, 0]
+EXACTLY_ONE_LITERALS = [1, 2, 3, -1, -2, -2, -3, -1, -3]
+EXACTLY_ONE_OFFSETS = [0, 3, 5, 7, 9]
+
+
+def clauses_of(literals):
+    clauses, clause = [], []
+    for lit in literals:
+        if lit == 0:
+            clauses.append(clause)
+            clause = []
+        else:
+            clause.append(lit)
+    return clauses
+
+
+class ArrayFormulaTests(unittest.TestCase):
+    def check_sat(self, formula, assumptions=()):
+        solver = Solver()
+        status = solver.solve(formula, assumptions=np.array(assumptions, dtype=np.int32))
+        self.assertEqual(status, SolveStatus.SAT)
+        self.assertEqual(solver.status, SolveStatus.SAT)
+
+        model = solver.model
+        self.assertEqual(model.dtype, np.int32)
+        self.assertEqual(list(np.abs(model)), [1, 2, 3])
+        assigned = set(model.tolist())
+        for clause in clauses_of(EXACTLY_ONE):
+            self.assertTrue(assigned.intersection(clause), clause)
+        self.assertTrue(assigned.issuperset(assumptions))
+        return solver
+
+    def test_from_array(self):
+        formula = Formula.from_array(np.array(EXACTLY_ONE, dtype=np.int32))
+        self.assertEqual(formula.num_variables, 3)
+        self.assertEqual(formula.num_clauses, 4)
+        self.check_sat(formula)
+
+    def test_from_csr(self):
+        formula = Formula.from_csr(np.array(EXACTLY_ONE_LITERALS, dtype=np.int32),
+                                   np.array(EXACTLY_ONE_OFFSETS, dtype=np.int32))
+        self.assertEqual(formula.num_variables, 3)
+        self.assertEqual(formula.num_clauses, 4)
+        self.check_sat(formula)
+
+    def test_from_csr_rejects_bad_offsets(self):
+        with self.assertRaises(ValueError):
+            Formula.from_csr(np.array([1, 2], dtype=np.int32), np.array([0, 3], dtype=np.int32))
+
+    def test_assumptions(self):
+        formula = Formula.from_array(np.array(EXACTLY_ONE, dtype=np.int32))
+        solver = self.check_sat(formula, assumptions=[-1, -2])
+        self.assertIn(3, solver.model.tolist())
+
+        # Two of the three cannot both hold
+        solver = Solver()
+        self.assertEqual(solver.solve(formula, assumptions=np.array([1, 2], dtype=np.int32)),
+                         SolveStatus.UNSAT)
+        self.assertEqual(solver.status, SolveStatus.UNSAT)
+
+    def test_stats(self):
+        formula = Formula.from_array(np.array(EXACTLY_ONE, dtype=np.int32))
+        solver = self.check_sat(formula)
+        stats = solver.stats
+        for key in ("decisions", "propagations", "conflicts", "failed_literals",
+                    "substituted_variables", "xor_propagations"):
+            self.assertGreaterEqual(stats[key], 0, key)
+        self.assertGreater(stats["decisions"] + stats["propagations"], 0)
+        self.assertGreaterEqual(stats["solve_time"], 0.0)
+
+    def test_formula_is_locked_while_solving(self):
+        # Pigeonhole 10 -> 9: far beyond what the search finishes quickly
+        holes = 9
+        formula = Formula()
+        for p in range(holes + 1):
+            formula.add_clause([p * holes + h + 1 for h in range(holes)])
+        for h in range(holes):
+            for p in range(holes + 1):
+                for q in range(p + 1, holes + 1):
+                    formula.add_clause([-(p * holes + h + 1), -(q * holes + h + 1)])
+
+        solver = Solver()
+        solver.set_timeout(2.0)
+        thread = threading.Thread(target=solver.solve, args=(formula,))
+        thread.start()
+        raised = False
+        while thread.is_alive() and not raised:
+            try:
+                formula.add_clause([1, -1])
+            except RuntimeError:
+                raised = True
+            time.sleep(0.001)
+        thread.join()
+        self.assertTrue(raised)
+        formula.add_clause([1, -1])  # free again once the solve is done
+
 
 if __name__ == "__main__":
-    if len(sys.argv) != 2:
-        print("Usage: python test_solve.py <cnf-file>")
-        sys.exit(1)
-    
-    cnf_path = sys.argv[1]
-    print(f"Testing StalmarckPy solver with file: {cnf_path}")
-    
-    try:
-        result = solve(cnf_path)
-        print(f"Result: {'SAT' if result else 'UNSAT'}")
-    except Exception as e:
-        print(f"Error: {e}")
-        sys.exit(1)
\ No newline at end of file
+    # With a CNF file, solve it; without arguments, run the tests
+    if len(sys.argv) == 2:
+        cnf_path = sys.argv[1]
+        print(f"Testing StalmarckPy solver with file: {cnf_path}")
+
+        try:
+            result = solve(cnf_path)
+            print(f"Result: {'SAT' if result else 'UNSAT'}")
+        except Exception as e:
+            print(f"Error: {e}")
+            sys.exit(1)
+    else:
+        unittest.main()
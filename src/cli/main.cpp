@@ -1,39 +1,474 @@
 #include "../core/stalmarck.hpp"
+#include "../core/batch.hpp"
+#include "../core/cube.hpp"
+#include "../core/portfolio.hpp"
+#include "../core/server.hpp"
+#include "../core/result_cache.hpp"
+#include "../core/gates.hpp"
+#include "../core/trace.hpp"
+#include "../core/perf_counters.hpp"
 #include "../parser/parser.hpp"
+#include "../solver/symmetry.hpp"
+#include "../solver/gauss.hpp"
+#include <csignal>
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
 
-int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <cnf-file>" << std::endl;
-        return 1;
+namespace {
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <cnf-file|aiger-file|prop-file>\n"
+              << "       " << program << " [options] --batch <directory|file-list>\n"
+              << "       " << program << " [options] --manifest <file>\n"
+              << "       " << program << " [options] --cubes <depth> <cnf-file>\n"
+              << "       " << program << " [options] --portfolio <cnf-file>\n"
+              << "       " << program << " [options] --serve <socket-path>\n"
+              << "\n"
+              << "Options:\n"
+              << "  --timeout <seconds>  per-instance time limit (UNKNOWN when exceeded)\n"
+              << "  --serve <socket>     serve solve requests on a Unix socket (see README)\n"
+              << "  --cache-size <n>     formulas kept encoded by --serve (default: 64)\n"
+              << "  --cache <dir>        reuse answers for repeated instances from this directory\n"
+              << "  --jobs <n>           batch/portfolio threads or cube workers (default: all cores)\n"
+              << "  --portfolio          race differently configured solvers that share facts\n"
+              << "  --no-share           portfolio solvers do not share facts\n"
+              << "  --cubes <depth>      cube-and-conquer over worker processes\n"
+              << "  --worker-cmd <cmd>   run cube workers with this command, e.g. \"ssh node StalmarckSAT\"\n"
+              << "  --cube-worker        answer cubes on stdin/stdout (used by --worker-cmd)\n"
+              << "  --lookahead <n>      choose splits by probing up to n variables\n"
+              << "  --probe-threads <n>  lookahead probing threads (default: 1, 0 = all cores)\n"
+              << "  --inprocess          simplify the formula during search\n"
+              << "  --compact            two-bit assignments for very large formulas\n"
+              << "  --local-search <s>   local search for up to s seconds first (with --portfolio: a member)\n"
+              << "  --symmetry           add symmetry-breaking clauses before solving\n"
+              << "  --symmetry-prefix <n> variables per symmetry-breaking chain (default: all with --gates, else 1)\n"
+              << "  --gates              recover circuit gates from the clauses before solving\n"
+              << "  --xor                find XOR constraints among the clauses and eliminate over them\n"
+              << "  --tautology          check that a .prop formula is a tautology\n"
+              << "  --trace <file>       write a Chrome trace of the solve phases\n"
+              << "  --stats              print solver counters and per-phase hardware counters\n"
+              << "  -h, --help           display this help\n";
+}
+
+const char* status_name(stalmarck::SolveStatus status) {
+    switch (status) {
+        case stalmarck::SolveStatus::SAT: return "SAT";
+        case stalmarck::SolveStatus::UNSAT: return "UNSAT";
+        default: return "UNKNOWN";
+    }
+}
+
+// With --tautology the negated formula is solved: UNSAT means valid
+const char* result_name(stalmarck::SolveStatus status, bool tautology) {
+    if (!tautology) {
+        return status_name(status);
+    }
+    switch (status) {
+        case stalmarck::SolveStatus::SAT: return "FALSIFIABLE";
+        case stalmarck::SolveStatus::UNSAT: return "TAUTOLOGY";
+        default: return "UNKNOWN";
+    }
+}
+
+// Standard SAT solver exit codes
+int exit_code(stalmarck::SolveStatus status) {
+    switch (status) {
+        case stalmarck::SolveStatus::SAT: return 10;
+        case stalmarck::SolveStatus::UNSAT: return 20;
+        default: return 0;
+    }
+}
+
+// Records a trace from construction and writes it when main returns,
+// whichever mode ran
+class TraceFile {
+public:
+    explicit TraceFile(std::string path) : path_(std::move(path)) {
+        if (!path_.empty()) {
+            stalmarck::start_trace();
+            stalmarck::set_trace_thread_name("main");
+        }
+    }
+
+    ~TraceFile() {
+        if (!path_.empty() && !stalmarck::write_trace_file(path_)) {
+            std::cerr << "Warning: could not write trace to " << path_ << std::endl;
+        }
+    }
+
+private:
+    std::string path_;
+};
+
+void print_count(std::ostream& out, int width, int64_t count) {
+    if (count < 0) {
+        out << std::setw(width) << "-";
+    } else {
+        out << std::setw(width) << count;
+    }
+}
+
+// One row of the --stats phase table
+void print_phase(std::ostream& out, const char* name, const stalmarck::PhaseCounters& phase) {
+    out << "c " << std::left << std::setw(10) << name << std::right
+        << std::fixed << std::setprecision(4) << std::setw(10) << phase.seconds;
+    print_count(out, 15, phase.cycles);
+    print_count(out, 15, phase.instructions);
+    if (phase.cycles > 0 && phase.instructions >= 0) {
+        out << std::setprecision(2) << std::setw(7)
+            << static_cast<double>(phase.instructions) / static_cast<double>(phase.cycles);
+    } else {
+        out << std::setw(7) << "-";
+    }
+    print_count(out, 13, phase.l1d_misses);
+    print_count(out, 13, phase.llc_misses);
+    print_count(out, 13, phase.branch_misses);
+    out << '\n';
+}
+
+// --stats output, as comment lines ahead of the result; solver is null
+// when the search ran elsewhere (portfolio, cubes)
+void print_stats(std::ostream& out, bool counters_available,
+                 const stalmarck::PhaseCounters& parse, const stalmarck::PhaseCounters& encode,
+                 const stalmarck::SolverStats* solver) {
+    if (solver != nullptr) {
+        out << "c decisions             " << solver->decisions << '\n'
+            << "c propagations          " << solver->propagations << '\n'
+            << "c conflicts             " << solver->conflicts << '\n'
+            << "c failed literals       " << solver->failed_literals << '\n'
+            << "c substituted variables " << solver->substituted_variables << '\n'
+            << "c xor propagations      " << solver->xor_propagations << '\n';
+    }
+    out << "c phase        seconds         cycles   instructions    IPC   L1d misses   LLC misses   br. misses\n";
+    print_phase(out, "parse", parse);
+    print_phase(out, "encode", encode);
+    if (solver != nullptr) {
+        print_phase(out, "propagate", solver->propagation_phase);
+        print_phase(out, "search", solver->search_phase);
+    }
+    if (!counters_available) {
+        out << "c hardware counters unavailable (perf_event_open denied), times only\n";
     }
+}
+
+// The running server, for the signal handler
+stalmarck::SolverServer* active_server = nullptr;
+
+void stop_server(int) {
+    if (active_server != nullptr) {
+        active_server->stop();
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filename;
+    std::string batch_path;
+    std::string manifest_path;
+    double timeout = 0.0;
+    size_t jobs = 0;
+    size_t lookahead = 0;
+    size_t probe_threads = 1;
+    bool inprocess = false;
+    bool compact = false;
+    double local_search = 0.0;
+    bool symmetry = false;
+    size_t symmetry_prefix = 0; // 0 = by encoding, see SymmetryOptions
+    bool gates = false;
+    bool xors = false;
+    bool tautology = false;
+    size_t cube_depth = 0;
+    std::string worker_cmd;
+    bool cube_worker = false;
+    bool portfolio = false;
+    bool share = true;
+    std::string serve_path;
+    size_t cache_size = 64;
+    std::string cache_dir;
+    std::string trace_path;
+    bool stats = false;
 
-    std::string filename = argv[1];
-    
     try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "-h" || arg == "--help") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (arg == "--batch" && has_value) {
+                batch_path = argv[++i];
+            } else if (arg == "--manifest" && has_value) {
+                manifest_path = argv[++i];
+            } else if (arg == "--timeout" && has_value) {
+                timeout = std::stod(argv[++i]);
+            } else if (arg == "--jobs" && has_value) {
+                jobs = std::stoul(argv[++i]);
+            } else if (arg == "--lookahead" && has_value) {
+                lookahead = std::stoul(argv[++i]);
+            } else if (arg == "--probe-threads" && has_value) {
+                probe_threads = std::stoul(argv[++i]);
+            } else if (arg == "--inprocess") {
+                inprocess = true;
+            } else if (arg == "--compact") {
+                compact = true;
+            } else if (arg == "--local-search" && has_value) {
+                local_search = std::stod(argv[++i]);
+            } else if (arg == "--symmetry") {
+                symmetry = true;
+            } else if (arg == "--symmetry-prefix" && has_value) {
+                symmetry_prefix = std::stoul(argv[++i]);
+            } else if (arg == "--gates") {
+                gates = true;
+            } else if (arg == "--xor") {
+                xors = true;
+            } else if (arg == "--tautology") {
+                tautology = true;
+            } else if (arg == "--serve" && has_value) {
+                serve_path = argv[++i];
+            } else if (arg == "--cache" && has_value) {
+                cache_dir = argv[++i];
+            } else if (arg == "--trace" && has_value) {
+                trace_path = argv[++i];
+            } else if (arg == "--stats") {
+                stats = true;
+            } else if (arg == "--cache-size" && has_value) {
+                cache_size = std::stoul(argv[++i]);
+            } else if (arg == "--portfolio") {
+                portfolio = true;
+            } else if (arg == "--no-share") {
+                share = false;
+            } else if (arg == "--cubes" && has_value) {
+                cube_depth = std::stoul(argv[++i]);
+            } else if (arg == "--worker-cmd" && has_value) {
+                worker_cmd = argv[++i];
+            } else if (arg == "--cube-worker") {
+                cube_worker = true;
+            } else if (arg[0] != '-' && filename.empty()) {
+                filename = arg;
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        TraceFile trace(trace_path);
+
+        // Service mode: serve requests until SIGINT or SIGTERM, with
+        // --timeout capping each request
+        if (!serve_path.empty()) {
+            stalmarck::SolverServer server;
+            server.set_workers(jobs);
+            server.set_cache_size(cache_size);
+            server.set_max_timeout(timeout);
+            if (!server.listen(serve_path)) {
+                std::cerr << "Error: " << server.get_error() << std::endl;
+                return 1;
+            }
+            active_server = &server;
+            std::signal(SIGINT, stop_server);
+            std::signal(SIGTERM, stop_server);
+            server.run();
+            active_server = nullptr;
+            return 0;
+        }
+
+        // Batch mode: stream one JSON line per instance
+        if (!batch_path.empty() || !manifest_path.empty()) {
+            stalmarck::BatchSolver batch;
+            batch.set_threads(jobs);
+            batch.set_timeout(timeout);
+            batch.set_lookahead(lookahead);
+            batch.set_inprocessing(inprocess);
+            batch.set_compact(compact);
+            batch.set_local_search(local_search);
+            batch.set_symmetry_breaking(symmetry, symmetry_prefix);
+            batch.set_gate_recovery(gates);
+            batch.set_xor_detection(xors);
+            batch.set_result_cache(cache_dir);
+
+            if (!manifest_path.empty()) {
+                batch.add_manifest(manifest_path);
+            } else if (std::filesystem::is_directory(batch_path)) {
+                batch.add_directory(batch_path);
+            } else {
+                batch.add_file_list(batch_path);
+            }
+            if (batch.has_error()) {
+                std::cerr << "Error: " << batch.get_error() << std::endl;
+                return 1;
+            }
+
+            batch.run(std::cout);
+            return 0;
+        }
+
+        if (filename.empty()) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        // With --stats, counting covers the loading threads too
+        std::unique_ptr<stalmarck::PerfCounters> counters;
+        stalmarck::PhaseCounters parse_start;
+        stalmarck::PhaseCounters parse_phase;
+        stalmarck::PhaseCounters encode_phase;
+        if (stats) {
+            counters = std::make_unique<stalmarck::PerfCounters>();
+            parse_start = counters->read();
+        }
+
+        // A single instance waits on its load, so overlap reading, parsing
+        // and encoding when there are cores to overlap them on
         stalmarck::Parser parser;
-        stalmarck::Formula formula = parser.parse_dimacs(filename);
-        
+        parser.set_pipelined(std::thread::hardware_concurrency() > 1);
+        if (tautology && (filename.size() < 5 || filename.compare(filename.size() - 5, 5, ".prop") != 0)) {
+            std::cerr << "Error: --tautology needs a propositional formula (.prop)" << std::endl;
+            return 1;
+        }
+        stalmarck::Formula formula = tautology ? parser.parse_expression(filename, true)
+                                               : parser.parse_file(filename);
+
         if (parser.has_error()) {
             std::cerr << "Error parsing file: " << parser.get_error() << std::endl;
             return 1;
         }
+        if (counters) {
+            parse_phase = stalmarck::phase_difference(counters->read(), parse_start);
+        }
 
-        stalmarck::StalmarckSolver solver;
-        bool success = solver.solve(formula);
-        
-        if (!success) {
-            std::cerr << "Error during solving" << std::endl;
-            return 1;
+        // A cached answer skips solving entirely
+        std::unique_ptr<stalmarck::ResultCache> cache;
+        uint64_t cache_key = 0;
+        if (!cache_dir.empty()) {
+            cache = std::make_unique<stalmarck::ResultCache>(cache_dir);
+            cache_key = stalmarck::ResultCache::key(formula.canonical_hash(), symmetry,
+                                                    symmetry_prefix, xors, gates);
+            stalmarck::CachedResult hit;
+            if (cache->lookup(cache_key, hit)) {
+                std::cout << result_name(hit.status, tautology) << std::endl;
+                return exit_code(hit.status);
+            }
+        }
+
+        // The cache key is that of the formula as given, with these options
+        if (symmetry) {
+            stalmarck::SymmetryOptions options;
+            options.max_prefix = symmetry_prefix ? symmetry_prefix : gates ? SIZE_MAX : 1;
+            stalmarck::break_symmetries(formula, options);
+        }
+        if (xors) {
+            stalmarck::extract_xors(formula);
+        }
+        if (gates && !formula.is_structural()) {
+            stalmarck::recover_gates(formula);
+        }
+
+        // Workers get the same options as the coordinator, so they solve
+        // the formula the cubes were split on
+        if (cube_worker) {
+            return stalmarck::run_cube_worker(formula, STDIN_FILENO, STDOUT_FILENO, timeout);
+        }
+
+        // Encode ahead of the solve to time it apart
+        if (counters) {
+            stalmarck::PhaseCounters encode_start = counters->read();
+            formula.get_triplets();
+            encode_phase = stalmarck::phase_difference(counters->read(), encode_start);
+        }
+
+        stalmarck::SolveStatus status = stalmarck::SolveStatus::UNKNOWN;
+        std::vector<int> model;
+        stalmarck::SolverStats solver_stats;
+        bool has_solver_stats = false;
+        if (cube_depth > 0) {
+            // Cube-and-conquer over worker processes
+            stalmarck::CubeSolver cubes;
+            cubes.set_workers(jobs);
+            cubes.set_depth(cube_depth);
+            if (lookahead > 0) {
+                cubes.set_lookahead(lookahead);
+            }
+            cubes.set_timeout(timeout);
+            if (!worker_cmd.empty()) {
+                std::istringstream words(worker_cmd);
+                std::vector<std::string> command;
+                for (std::string word; words >> word;) {
+                    command.push_back(word);
+                }
+                cubes.set_worker_command(command);
+
+                std::vector<std::string> options;
+                for (const auto& [enabled, option] : {std::pair<bool, const char*>{tautology, "--tautology"},
+                                                      {symmetry, "--symmetry"},
+                                                      {xors, "--xor"},
+                                                      {gates, "--gates"}}) {
+                    if (enabled) {
+                        options.push_back(option);
+                    }
+                }
+                if (symmetry_prefix) {
+                    options.push_back("--symmetry-prefix");
+                    options.push_back(std::to_string(symmetry_prefix));
+                }
+                cubes.set_worker_options(options);
+            }
+            if (!cubes.solve(formula, filename)) {
+                std::cerr << "Error: " << cubes.get_error() << std::endl;
+                return 1;
+            }
+            status = cubes.get_status();
+            model = cubes.get_model();
+        } else if (portfolio) {
+            // Threaded portfolio with fact sharing
+            stalmarck::PortfolioSolver racers;
+            racers.set_threads(jobs);
+            racers.set_timeout(timeout);
+            racers.set_sharing(share);
+            racers.set_local_search(local_search > 0.0);
+            racers.solve(formula);
+            status = racers.get_status();
+            model = racers.get_model();
+        } else {
+            stalmarck::StalmarckSolver solver;
+            solver.set_timeout(timeout);
+            solver.set_lookahead(lookahead, probe_threads);
+            solver.set_inprocessing(inprocess);
+            solver.set_compact(compact);
+            solver.set_local_search(local_search);
+            solver.set_phase_counters(stats);
+            bool success = solver.solve(formula);
+
+            if (!success) {
+                std::cerr << "Error during solving" << std::endl;
+                return 1;
+            }
+            status = solver.get_status();
+            model = solver.get_model();
+            solver_stats = solver.get_stats();
+            has_solver_stats = true;
+        }
+
+        if (cache && !cache->store(cache_key, status, model)) {
+            std::cerr << "Warning: " << cache->get_error() << std::endl;
+        }
+
+        if (counters) {
+            print_stats(std::cout, counters->available(), parse_phase, encode_phase,
+                        has_solver_stats ? &solver_stats : nullptr);
         }
 
         // Print result
-        std::cout << (solver.is_tautology() ? "SAT" : "UNSAT") << std::endl;
-        return solver.is_tautology() ? 10 : 20;  // Standard SAT solver exit codes
+        std::cout << result_name(status, tautology) << std::endl;
+        return exit_code(status);
 
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
-}
\ No newline at end of file
+}
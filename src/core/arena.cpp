@@ -0,0 +1,58 @@
+#include "core/arena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace stalmarck {
+
+Arena::Arena(size_t block_size) : block_size_(block_size) {}
+Arena::~Arena() = default;
+
+void* Arena::allocate_bytes(size_t bytes, size_t align) {
+    while (true) {
+        if (current_ < blocks_.size()) {
+            Block& block = blocks_[current_];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            size_t aligned = ((base + offset_ + align - 1) & ~(align - 1)) - base;
+            if (aligned + bytes <= block.size) {
+                offset_ = aligned + bytes;
+                used_ += bytes;
+                return block.data.get() + aligned;
+            }
+            // Move on to the next retained block, if any
+            if (current_ + 1 < blocks_.size()) {
+                current_++;
+                offset_ = 0;
+                continue;
+            }
+        }
+
+        // Out of retained memory: grow
+        size_t size = std::max(block_size_, bytes + align);
+        blocks_.push_back({std::make_unique<unsigned char[]>(size), size});
+        current_ = blocks_.size() - 1;
+        offset_ = 0;
+    }
+}
+
+void Arena::reset() {
+    // Rewind over the retained blocks. A solve that spilled into several
+    // blocks carves them in the same order next time, so the same workload
+    // fits again without allocating
+    current_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const auto& block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+size_t Arena::used() const {
+    return used_;
+}
+
+} // namespace stalmarck
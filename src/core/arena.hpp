@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace stalmarck {
+
+// Monotonic bump allocator for per-solve state. Allocations are never freed
+// individually; reset() releases everything at once and keeps the memory, so
+// a solver that is reused reaches a steady state with no heap traffic and an
+// O(1) reset.
+class Arena {
+public:
+    explicit Arena(size_t block_size = 64 * 1024);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Uninitialised storage for n objects of a trivial type
+    template <typename T>
+    T* allocate(size_t n) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "arena memory is released without running destructors");
+        return static_cast<T*>(allocate_bytes(n * sizeof(T), alignof(T)));
+    }
+
+    // Zero-initialised variant
+    template <typename T>
+    T* allocate_zeroed(size_t n) {
+        T* ptr = allocate<T>(n);
+        std::memset(static_cast<void*>(ptr), 0, n * sizeof(T));
+        return ptr;
+    }
+
+    void reset();
+
+    size_t capacity() const;  // bytes owned
+    size_t used() const;      // bytes handed out since the last reset
+
+private:
+    void* allocate_bytes(size_t bytes, size_t align);
+
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+    std::vector<Block> blocks_;
+    size_t block_size_;
+    size_t current_ = 0;  // block being carved
+    size_t offset_ = 0;   // next free byte in blocks_[current_]
+    size_t used_ = 0;
+};
+
+} // namespace stalmarck
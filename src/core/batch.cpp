@@ -0,0 +1,305 @@
+#include "core/batch.hpp"
+#include "core/thread_pool.hpp"
+#include "core/result_cache.hpp"
+#include "core/gates.hpp"
+#include "core/trace.hpp"
+#include "solver/symmetry.hpp"
+#include "solver/gauss.hpp"
+#include "parser/parser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace stalmarck {
+
+namespace {
+
+struct BatchEntry {
+    std::string name;
+    std::string path;
+};
+
+// Lines of a list or manifest, without comments and surrounding whitespace
+std::vector<std::string> read_lines(std::ifstream& file) {
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        size_t last = line.find_last_not_of(" \t\r");
+        lines.push_back(line.substr(first, last - first + 1));
+    }
+    return lines;
+}
+
+// Relative entries in a list or manifest are relative to that file
+std::string resolve(const std::filesystem::path& list_path, const std::string& entry) {
+    std::filesystem::path path(entry);
+    if (path.is_relative()) {
+        path = list_path.parent_path() / path;
+    }
+    return path.string();
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+const char* status_name(SolveStatus status) {
+    switch (status) {
+        case SolveStatus::SAT: return "SAT";
+        case SolveStatus::UNSAT: return "UNSAT";
+        default: return "UNKNOWN";
+    }
+}
+
+} // namespace
+
+class BatchSolver::Impl {
+public:
+    std::vector<BatchEntry> entries;
+    size_t threads = 0;
+    double timeout = 0.0;
+    size_t lookahead_candidates = 0;
+    bool inprocessing = false;
+    bool compact = false;
+    double local_search = 0.0;
+    bool symmetry_breaking = false;
+    size_t symmetry_prefix = 0;
+    bool gate_recovery = false;
+    bool xor_detection = false;
+    std::string cache_directory;
+    std::string error_message;
+    bool has_error_flag = false;
+
+    bool fail(const std::string& message) {
+        error_message = message;
+        has_error_flag = true;
+        return false;
+    }
+};
+
+BatchSolver::BatchSolver() : impl_(std::make_unique<Impl>()) {}
+BatchSolver::~BatchSolver() = default;
+
+bool BatchSolver::add_file(const std::string& path, const std::string& name) {
+    impl_->entries.push_back({name.empty() ? path : name, path});
+    return true;
+}
+
+bool BatchSolver::add_directory(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::directory_iterator it(path, ec);
+    if (ec) {
+        return impl_->fail("Could not open directory: " + path);
+    }
+
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : it) {
+        auto extension = entry.path().extension();
+        if (entry.is_regular_file() && (extension == ".cnf" || extension == ".aag" || extension == ".aig" || extension == ".prop")) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        add_file(file.string(), file.filename().string());
+    }
+    return true;
+}
+
+bool BatchSolver::add_file_list(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return impl_->fail("Could not open file list: " + path);
+    }
+    for (const auto& line : read_lines(file)) {
+        add_file(resolve(path, line), line);
+    }
+    return true;
+}
+
+bool BatchSolver::add_manifest(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return impl_->fail("Could not open manifest: " + path);
+    }
+    for (const auto& line : read_lines(file)) {
+        std::istringstream iss(line);
+        std::string name, entry;
+        if (!(iss >> name >> entry)) {
+            return impl_->fail("Invalid manifest line: " + line);
+        }
+        add_file(resolve(path, entry), name);
+    }
+    return true;
+}
+
+size_t BatchSolver::size() const {
+    return impl_->entries.size();
+}
+
+void BatchSolver::set_threads(size_t threads) {
+    impl_->threads = threads;
+}
+
+void BatchSolver::set_timeout(double seconds) {
+    impl_->timeout = seconds;
+}
+
+void BatchSolver::set_lookahead(size_t candidates) {
+    impl_->lookahead_candidates = candidates;
+}
+
+void BatchSolver::set_inprocessing(bool enabled) {
+    impl_->inprocessing = enabled;
+}
+
+void BatchSolver::set_compact(bool enabled) {
+    impl_->compact = enabled;
+}
+
+void BatchSolver::set_local_search(double seconds) {
+    impl_->local_search = seconds;
+}
+
+void BatchSolver::set_symmetry_breaking(bool enabled, size_t max_prefix) {
+    impl_->symmetry_breaking = enabled;
+    impl_->symmetry_prefix = max_prefix;
+}
+
+void BatchSolver::set_gate_recovery(bool enabled) {
+    impl_->gate_recovery = enabled;
+}
+
+void BatchSolver::set_xor_detection(bool enabled) {
+    impl_->xor_detection = enabled;
+}
+
+void BatchSolver::set_result_cache(const std::string& directory) {
+    impl_->cache_directory = directory;
+}
+
+void BatchSolver::run(const std::function<void(const BatchResult&)>& on_result) {
+    ThreadPool pool(impl_->threads);
+
+    // One parser and solver per worker, reused for every instance it takes
+    std::vector<Parser> parsers(pool.size());
+    std::vector<StalmarckSolver> solvers(pool.size());
+    for (auto& solver : solvers) {
+        solver.set_timeout(impl_->timeout);
+        // Workers already run in parallel, so each one probes on its own thread
+        solver.set_lookahead(impl_->lookahead_candidates, 1);
+        solver.set_inprocessing(impl_->inprocessing);
+        solver.set_compact(impl_->compact);
+        solver.set_local_search(impl_->local_search);
+    }
+
+    std::unique_ptr<ResultCache> cache;
+    if (!impl_->cache_directory.empty()) {
+        cache = std::make_unique<ResultCache>(impl_->cache_directory);
+    }
+
+    std::mutex result_mutex;
+    for (const auto& entry : impl_->entries) {
+        pool.submit([&, entry](size_t worker) {
+            set_trace_thread_name("batch " + std::to_string(worker));
+            TraceSpan span("instance");
+            auto start = std::chrono::steady_clock::now();
+            BatchResult result;
+            result.name = entry.name;
+
+            Formula formula = parsers[worker].parse_file(entry.path);
+            if (pool.size() > 1) {
+                // The workers already keep every core busy
+                formula.set_encoding_threads(1);
+            }
+            if (parsers[worker].has_error()) {
+                result.error = parsers[worker].get_error();
+            } else {
+                uint64_t key = cache ? ResultCache::key(formula.canonical_hash(),
+                                                        impl_->symmetry_breaking,
+                                                        impl_->symmetry_prefix,
+                                                        impl_->xor_detection,
+                                                        impl_->gate_recovery)
+                                     : 0;
+                CachedResult hit;
+                if (cache && cache->lookup(key, hit)) {
+                    result.status = hit.status;
+                    result.cached = true;
+                } else {
+                    if (impl_->symmetry_breaking) {
+                        SymmetryOptions options;
+                        options.max_prefix = impl_->symmetry_prefix ? impl_->symmetry_prefix
+                                           : impl_->gate_recovery ? SIZE_MAX : 1;
+                        break_symmetries(formula, options);
+                    }
+                    if (impl_->xor_detection) {
+                        extract_xors(formula);
+                    }
+                    if (impl_->gate_recovery && !formula.is_structural()) {
+                        recover_gates(formula);
+                    }
+                    solvers[worker].solve(formula);
+                    result.status = solvers[worker].get_status();
+                    if (cache) {
+                        cache->store(key, result.status, solvers[worker].get_model());
+                    }
+                }
+            }
+            result.seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(result_mutex);
+            on_result(result);
+        });
+    }
+    pool.wait();
+}
+
+void BatchSolver::run(std::ostream& out) {
+    run([&out](const BatchResult& result) {
+        out << to_json_line(result) << std::endl;
+    });
+}
+
+bool BatchSolver::has_error() const {
+    return impl_->has_error_flag;
+}
+
+std::string BatchSolver::get_error() const {
+    return impl_->error_message;
+}
+
+std::string to_json_line(const BatchResult& result) {
+    std::ostringstream ss;
+    ss << "{\"name\": \"" << json_escape(result.name) << "\", \"result\": \""
+       << (result.error.empty() ? status_name(result.status) : "ERROR") << "\", \"time\": "
+       << std::fixed << std::setprecision(6) << result.seconds;
+    if (!result.error.empty()) {
+        ss << ", \"error\": \"" << json_escape(result.error) << "\"";
+    }
+    if (result.cached) {
+        ss << ", \"cached\": true";
+    }
+    ss << "}";
+    return ss.str();
+}
+
+} // namespace stalmarck
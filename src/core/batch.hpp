@@ -0,0 +1,64 @@
+#pragma once
+
+#include "stalmarck.hpp"
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace stalmarck {
+
+// One solved instance of a batch
+struct BatchResult {
+    std::string name;
+    SolveStatus status = SolveStatus::UNKNOWN;
+    double seconds = 0.0;
+    std::string error; // non-empty if the instance could not be read
+    bool cached = false; // answered from the result cache
+};
+
+// Solves many small CNF files concurrently. Each worker thread keeps one
+// StalmarckSolver for its whole share of the batch, so solver state is
+// allocated once per thread rather than once per instance.
+class BatchSolver {
+public:
+    BatchSolver();
+    ~BatchSolver();
+
+    // Input collection; return false and set the error on failure
+    bool add_file(const std::string& path, const std::string& name = "");
+    bool add_directory(const std::string& path);    // every *.cnf, *.aag, *.aig and *.prop, sorted
+    bool add_file_list(const std::string& path);    // one path per line
+    bool add_manifest(const std::string& path);     // "<name> <path>" per line
+    size_t size() const;
+
+    // Configuration methods
+    void set_threads(size_t threads);  // 0 = hardware concurrency
+    void set_timeout(double seconds);  // per instance, 0 = none
+    void set_lookahead(size_t candidates); // lookahead splits, 0 = off
+    void set_inprocessing(bool enabled);
+    void set_compact(bool enabled);    // two-bit assignments, see Solver
+    void set_local_search(double seconds); // pre-phase, see StalmarckSolver
+    void set_symmetry_breaking(bool enabled, size_t max_prefix = 0); // see break_symmetries, 0 = by encoding
+    void set_gate_recovery(bool enabled);     // see recover_gates
+    void set_xor_detection(bool enabled);     // see extract_xors
+    void set_result_cache(const std::string& directory); // see ResultCache, "" = off
+
+    // Solve everything; results arrive in completion order, one call at a time
+    void run(const std::function<void(const BatchResult&)>& on_result);
+    void run(std::ostream& out);       // JSON lines
+
+    // Error handling
+    bool has_error() const;
+    std::string get_error() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// {"name": ..., "result": "SAT"|"UNSAT"|"UNKNOWN"|"ERROR", "time": ...}
+std::string to_json_line(const BatchResult& result);
+
+} // namespace stalmarck
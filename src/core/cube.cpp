@@ -0,0 +1,310 @@
+#include "core/cube.hpp"
+#include "core/line_io.hpp"
+#include "solver/solver.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <sstream>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace stalmarck {
+
+int run_cube_worker(const Formula& formula, int in_fd, int out_fd, double timeout) {
+    StalmarckSolver solver;
+    solver.set_timeout(timeout);
+
+    LineReader reader(in_fd);
+    std::string line;
+    std::vector<int> cube;
+    while (reader.read_line(line)) {
+        std::istringstream in(line);
+        std::string tag;
+        if (!(in >> tag) || tag != "c" || !parse_literals(in, cube)) {
+            return 1;
+        }
+
+        solver.solve(formula, cube);
+        std::string reply;
+        switch (solver.get_status()) {
+            case SolveStatus::SAT: reply = format_literals("SAT", solver.get_model()); break;
+            case SolveStatus::UNSAT: reply = "UNSAT\n"; break;
+            default: reply = "UNKNOWN\n"; break;
+        }
+        if (!write_all(out_fd, reply, false)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+class CubeSolver::Impl {
+public:
+    struct Worker {
+        pid_t pid = -1;
+        int fd = -1;
+        LineReader reader{-1};
+        bool busy = false;
+    };
+
+    size_t workers = 0;
+    size_t depth = 8;
+    size_t lookahead = 16;
+    double timeout = 0.0;
+    std::vector<std::string> command;
+    std::vector<std::string> worker_options;
+
+    SolveStatus status = SolveStatus::UNKNOWN;
+    std::vector<int> model;
+    size_t num_cubes = 0;
+    std::string error_message;
+    bool has_error_flag = false;
+
+    bool fail(const std::string& message) {
+        error_message = message;
+        has_error_flag = true;
+        return false;
+    }
+
+    // Fork one worker connected over a socket pair. The child closes the
+    // coordinator's ends of earlier workers so each sees end of input as
+    // soon as the coordinator closes its socket.
+    bool spawn(const Formula& formula, const std::string& path, std::vector<Worker>& pool) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            return fail("socketpair failed");
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            return fail("fork failed");
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            for (const auto& worker : pool) {
+                close(worker.fd);
+            }
+            if (command.empty()) {
+                _exit(run_cube_worker(formula, fds[1], fds[1], timeout));
+            }
+
+            dup2(fds[1], STDIN_FILENO);
+            dup2(fds[1], STDOUT_FILENO);
+            close(fds[1]);
+            std::vector<std::string> args = command;
+            args.push_back("--cube-worker");
+            args.push_back(path);
+            args.insert(args.end(), worker_options.begin(), worker_options.end());
+            if (timeout > 0.0) {
+                args.push_back("--timeout");
+                args.push_back(std::to_string(timeout));
+            }
+            std::vector<char*> argv;
+            for (auto& arg : args) {
+                argv.push_back(arg.data());
+            }
+            argv.push_back(nullptr);
+            execvp(argv[0], argv.data());
+            _exit(127);
+        }
+
+        close(fds[1]);
+        Worker worker;
+        worker.pid = pid;
+        worker.fd = fds[0];
+        worker.reader = LineReader(fds[0]);
+        pool.push_back(std::move(worker));
+        return true;
+    }
+
+    // Close every socket and reap the workers; kill them first when the
+    // search stopped early and some may still be solving
+    void shut_down(std::vector<Worker>& pool, bool cancel) {
+        for (auto& worker : pool) {
+            if (cancel) {
+                kill(worker.pid, SIGTERM);
+            }
+            close(worker.fd);
+        }
+        for (auto& worker : pool) {
+            int wstatus;
+            while (waitpid(worker.pid, &wstatus, 0) < 0 && errno == EINTR) {
+            }
+        }
+    }
+};
+
+CubeSolver::CubeSolver() : impl_(std::make_unique<Impl>()) {}
+CubeSolver::~CubeSolver() = default;
+
+void CubeSolver::set_workers(size_t workers) {
+    impl_->workers = workers;
+}
+
+void CubeSolver::set_depth(size_t depth) {
+    impl_->depth = depth;
+}
+
+void CubeSolver::set_lookahead(size_t candidates) {
+    impl_->lookahead = candidates;
+}
+
+void CubeSolver::set_timeout(double seconds) {
+    impl_->timeout = seconds;
+}
+
+void CubeSolver::set_worker_command(const std::vector<std::string>& command) {
+    impl_->command = command;
+}
+
+void CubeSolver::set_worker_options(const std::vector<std::string>& options) {
+    impl_->worker_options = options;
+}
+
+bool CubeSolver::solve(const Formula& formula, const std::string& path) {
+    impl_->status = SolveStatus::UNKNOWN;
+    impl_->model.clear();
+    impl_->has_error_flag = false;
+    impl_->error_message.clear();
+    if (!impl_->command.empty() && path.empty()) {
+        return impl_->fail("worker command given without a CNF path");
+    }
+
+    // Cube on this process, then encode once so forked workers inherit it
+    std::vector<std::vector<int>> cubes;
+    {
+        Solver cuber;
+        cuber.set_lookahead(impl_->lookahead);
+        cuber.make_cubes(formula, impl_->depth, cubes);
+    }
+    impl_->num_cubes = cubes.size();
+    if (cubes.empty()) {
+        impl_->status = SolveStatus::UNSAT;
+        return true;
+    }
+    formula.get_triplets();
+
+    size_t num_workers = impl_->workers;
+    if (num_workers == 0) {
+        num_workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_workers = std::min(num_workers, cubes.size());
+
+    std::vector<Impl::Worker> pool;
+    for (size_t i = 0; i < num_workers; ++i) {
+        if (!impl_->spawn(formula, path, pool)) {
+            impl_->shut_down(pool, true);
+            return false;
+        }
+    }
+
+    size_t next_cube = 0;
+    auto dispatch = [&](Impl::Worker& worker) {
+        if (next_cube == cubes.size()) {
+            return true;
+        }
+        worker.busy = true;
+        return write_all(worker.fd, format_literals("c", cubes[next_cube++]), true);
+    };
+    for (auto& worker : pool) {
+        if (!dispatch(worker)) {
+            impl_->shut_down(pool, true);
+            return impl_->fail("could not send a cube to a worker");
+        }
+    }
+
+    bool found_sat = false;
+    bool any_unknown = false;
+    bool ok = true;
+    std::vector<pollfd> fds;
+    std::vector<size_t> polled;
+    std::string line;
+    while (ok && !found_sat) {
+        fds.clear();
+        polled.clear();
+        for (size_t i = 0; i < pool.size(); ++i) {
+            if (pool[i].busy) {
+                fds.push_back({pool[i].fd, POLLIN, 0});
+                polled.push_back(i);
+            }
+        }
+        if (fds.empty()) {
+            break;
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok = impl_->fail("poll failed");
+            break;
+        }
+
+        for (size_t k = 0; k < fds.size() && ok && !found_sat; ++k) {
+            if (fds[k].revents == 0) {
+                continue;
+            }
+            Impl::Worker& worker = pool[polled[k]];
+            if (!worker.reader.fill()) {
+                ok = impl_->fail("a worker exited before answering");
+                break;
+            }
+            while (worker.reader.next_line(line)) {
+                std::istringstream in(line);
+                std::string answer;
+                in >> answer;
+                if (answer == "SAT" && parse_literals(in, impl_->model)) {
+                    found_sat = true;
+                    break;
+                } else if (answer == "UNKNOWN") {
+                    any_unknown = true;
+                } else if (answer != "UNSAT") {
+                    ok = impl_->fail("unexpected worker reply: " + line);
+                    break;
+                }
+                worker.busy = false;
+                if (!dispatch(worker)) {
+                    ok = impl_->fail("could not send a cube to a worker");
+                    break;
+                }
+            }
+        }
+    }
+
+    // Cancel the remaining cubes on the first SAT
+    impl_->shut_down(pool, found_sat || !ok);
+    if (!ok) {
+        return false;
+    }
+    if (found_sat) {
+        impl_->status = SolveStatus::SAT;
+    } else {
+        impl_->status = any_unknown ? SolveStatus::UNKNOWN : SolveStatus::UNSAT;
+    }
+    return true;
+}
+
+SolveStatus CubeSolver::get_status() const {
+    return impl_->status;
+}
+
+const std::vector<int>& CubeSolver::get_model() const {
+    return impl_->model;
+}
+
+size_t CubeSolver::num_cubes() const {
+    return impl_->num_cubes;
+}
+
+bool CubeSolver::has_error() const {
+    return impl_->has_error_flag;
+}
+
+std::string CubeSolver::get_error() const {
+    return impl_->error_message;
+}
+
+} // namespace stalmarck
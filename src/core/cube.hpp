@@ -0,0 +1,64 @@
+#pragma once
+
+#include "stalmarck.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stalmarck {
+
+// Cube-and-conquer over worker processes. A lookahead cuber splits the
+// formula into assumption cubes; a coordinator hands them one at a time to
+// worker processes over a line protocol on a socket, collects the answers,
+// and stops every worker on the first SAT.
+//
+// Workers are forked from the calling process by default. With a worker
+// command they are exec'd instead, talking over stdin/stdout, which lets a
+// command such as "ssh node StalmarckSAT" put workers on other machines
+// that share the filesystem holding the CNF file.
+//
+// Protocol, one message per line:
+//   coordinator -> worker   "c <lit> ... 0"          solve under this cube
+//   worker -> coordinator   "SAT <lit> ... 0" | "UNSAT" | "UNKNOWN"
+// The model sent with SAT lists every variable; end of input ends the worker.
+class CubeSolver {
+public:
+    CubeSolver();
+    ~CubeSolver();
+
+    // Configuration methods
+    void set_workers(size_t workers);      // 0 = hardware concurrency
+    void set_depth(size_t depth);          // cube length, default 8
+    void set_lookahead(size_t candidates); // cuber lookahead, default 16
+    void set_timeout(double seconds);      // per cube, 0 = none
+
+    // argv of the worker program; "--cube-worker <cnf-path>" is appended
+    void set_worker_command(const std::vector<std::string>& command);
+
+    // Options appended after the path, for every option the formula was
+    // read or transformed with (e.g. "--tautology", "--gates"), so exec'd
+    // workers solve the formula the cubes were split on
+    void set_worker_options(const std::vector<std::string>& options);
+
+    // Solve; path is the formula's CNF file, needed only by exec'd workers.
+    // Returns false and sets the error if the workers could not be run.
+    bool solve(const Formula& formula, const std::string& path = "");
+
+    SolveStatus get_status() const;
+    const std::vector<int>& get_model() const;
+    size_t num_cubes() const;  // cubes produced by the last solve
+
+    // Error handling
+    bool has_error() const;
+    std::string get_error() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Worker side of the protocol: answer cubes read from in_fd on out_fd until
+// end of input. Returns 0, or 1 on a protocol or I/O error.
+int run_cube_worker(const Formula& formula, int in_fd, int out_fd, double timeout = 0.0);
+
+} // namespace stalmarck
@@ -1,13 +1,20 @@
 #include "formula.hpp"
 #include "formula_impl.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
 #include <algorithm>
 #include <iostream>
 #include <tuple>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 
 namespace stalmarck {
 
+// Memory budgets assume a triplet is three packed 32-bit literals
+static_assert(sizeof(std::tuple<int, int, int>) == 3 * sizeof(int32_t),
+              "triplets must stay 12 bytes");
+
 // Debug helper function to print a clause
 std::string print_clause(const std::vector<int>& clause) {
     std::stringstream ss;
@@ -51,25 +58,286 @@ std::string print_triplets(const std::vector<std::tuple<int, int, int>>& triplet
     return ss.str();
 }
 
+TripletKind classify_triplet(int x, int y, int z) {
+    // Literal 0 never matches itself in the rules, so it never makes a
+    // triplet degenerate
+    bool x_equals_y = x == y && x != 0;
+    bool y_equals_z = y == z && y != 0;
+    if (x_equals_y && y_equals_z) return TripletKind::AllEqual;
+    if (x_equals_y) return TripletKind::XEqualsY;
+    if (y_equals_z) return TripletKind::YEqualsZ;
+    return TripletKind::General;
+}
+
+TripletKindOffsets group_triplets_by_kind(std::vector<std::tuple<int, int, int>>& triplets) {
+    auto kind_of = [](const std::tuple<int, int, int>& t) {
+        return static_cast<size_t>(classify_triplet(std::get<0>(t), std::get<1>(t), std::get<2>(t)));
+    };
+
+    // Counting sort keeps the order within each kind
+    TripletKindOffsets offsets{};
+    for (const auto& t : triplets) {
+        offsets[kind_of(t) + 1]++;
+    }
+    for (size_t k = 0; k < NUM_TRIPLET_KINDS; ++k) {
+        offsets[k + 1] += offsets[k];
+    }
+    if (offsets[1] != triplets.size()) {
+        std::vector<std::tuple<int, int, int>> bucketed(triplets.size());
+        TripletKindOffsets fill = offsets;
+        for (const auto& t : triplets) {
+            bucketed[fill[kind_of(t)]++] = t;
+        }
+        triplets = std::move(bucketed);
+    }
+    return offsets;
+}
+
+void Formula::Impl::bucket_triplets() {
+    triplet_kind_offsets = group_triplets_by_kind(triplets);
+}
+
+int Formula::Impl::current_literal(int lit) {
+    int var = std::abs(lit);
+    if (variable_map.empty() || static_cast<size_t>(var) > num_vars) {
+        return lit;
+    }
+    if (inverse_map.empty()) {
+        inverse_map.assign(num_vars + 1, 0);
+        for (size_t v = 1; v <= num_vars; ++v) {
+            inverse_map[variable_map[v]] = static_cast<int>(v);
+        }
+    }
+    return lit < 0 ? -inverse_map[var] : inverse_map[var];
+}
+
+void Formula::Impl::add_structural_clause(const std::vector<int>& literals) {
+    if (max_variable == 0) {
+        max_variable = static_cast<int>(num_vars);
+        for (const auto& [x, y, z] : triplets) {
+            max_variable = std::max({max_variable, std::abs(x), std::abs(y), std::abs(z)});
+        }
+    }
+
+    int top = static_cast<int>(num_vars);
+    for (int lit : literals) {
+        top = std::max(top, std::abs(lit));
+    }
+    int shift = top - static_cast<int>(num_vars);
+    if (shift > 0) {
+        int problem = static_cast<int>(num_vars);
+        auto move = [problem, shift](int& lit) {
+            if (std::abs(lit) > problem) {
+                lit += lit > 0 ? shift : -shift;
+            }
+        };
+        for (auto& [x, y, z] : triplets) {
+            move(x);
+            move(y);
+            move(z);
+        }
+        move(true_variable);
+        if (!variable_map.empty()) {
+            // New problem variables are not renumbered
+            variable_map.resize(num_vars + 1);
+            for (int v = problem + 1; v <= top; ++v) {
+                variable_map.push_back(v);
+            }
+        }
+        max_variable += shift;
+        num_vars = static_cast<size_t>(top);
+        inverse_map.clear();
+    }
+
+    std::vector<int> clause;
+    for (int lit : literals) {
+        clause.push_back(current_literal(lit));
+    }
+    if (clause.size() == 1) {
+        triplets.emplace_back(clause[0], clause[0], clause[0]);
+        return;
+    }
+    if (true_variable == 0) {
+        true_variable = ++max_variable;
+        triplets.emplace_back(true_variable, true_variable, true_variable);
+    }
+    if (clause.empty()) {
+        triplets.emplace_back(-true_variable, -true_variable, -true_variable);
+        return;
+    }
+    int rest = clause.back();
+    for (size_t j = clause.size() - 2; j > 0; --j) {
+        int v = ++max_variable;
+        triplets.emplace_back(v, -clause[j], rest);
+        rest = v;
+    }
+    triplets.emplace_back(true_variable, -clause[0], rest);
+}
+
 Formula::Formula() : impl_(std::make_unique<Impl>()) {}
 
 Formula::~Formula() = default;
 
+Formula::Formula(Formula&&) noexcept = default;
+Formula& Formula::operator=(Formula&&) noexcept = default;
+
 void Formula::add_clause(const std::vector<int>& literals) {
-    impl_->clauses.push_back(literals);
+    impl_->encoded.store(false, std::memory_order_relaxed);
+    if (impl_->structural) {
+        impl_->add_structural_clause(literals);
+        return;
+    }
+
+    // Clauses of a reordered formula are held in its new numbering
+    if (impl_->variable_map.empty()) {
+        impl_->clauses.push_back(literals);
+    } else {
+        std::vector<int> clause;
+        for (int lit : literals) {
+            clause.push_back(impl_->current_literal(lit));
+        }
+        impl_->clauses.push_back(std::move(clause));
+    }
     
     for (int lit : literals) {
         impl_->num_vars = std::max(impl_->num_vars, static_cast<size_t>(std::abs(lit)));
     }
 }
 
+void Formula::add_clauses(const int* literals, size_t count) {
+    // Clauses are separated by 0; a trailing clause without its 0 is kept
+    std::vector<int> clause;
+    for (size_t i = 0; i < count; ++i) {
+        if (literals[i] == 0) {
+            if (!clause.empty()) {
+                add_clause(clause);
+                clause.clear();
+            }
+            continue;
+        }
+        clause.push_back(literals[i]);
+    }
+    if (!clause.empty()) {
+        add_clause(clause);
+    }
+}
+
+void Formula::add_xor(const std::vector<int>& literals) {
+    XorConstraint constraint;
+    constraint.rhs = true;
+    for (int lit : literals) {
+        constraint.variables.push_back(std::abs(lit));
+        constraint.rhs ^= lit < 0;
+        impl_->num_vars = std::max(impl_->num_vars, static_cast<size_t>(std::abs(lit)));
+    }
+
+    // Pairs of equal variables cancel
+    auto& vars = constraint.variables;
+    std::sort(vars.begin(), vars.end());
+    size_t kept = 0;
+    for (size_t i = 0; i < vars.size();) {
+        if (i + 1 < vars.size() && vars[i] == vars[i + 1]) {
+            i += 2;
+        } else {
+            vars[kept++] = vars[i++];
+        }
+    }
+    vars.resize(kept);
+    impl_->xors.push_back(std::move(constraint));
+}
+
+const std::vector<XorConstraint>& Formula::get_xors() const {
+    return impl_->xors;
+}
+
+void Formula::set_triplets(std::vector<std::tuple<int, int, int>> triplets, size_t num_variables) {
+    impl_->clauses.clear();
+    impl_->drop_staged_encoding();
+    impl_->triplets = std::move(triplets);
+    impl_->num_vars = num_variables;
+    impl_->variable_map.clear();
+    impl_->inverse_map.clear();
+    impl_->true_variable = 0;
+    impl_->max_variable = 0;
+    impl_->structural = true;
+    impl_->bucket_triplets();
+    impl_->encoded.store(true, std::memory_order_release);
+}
+
+bool Formula::is_structural() const {
+    return impl_->structural;
+}
+
+namespace {
+
+// Canonical literal order within a clause
+void normalize_clause(std::vector<int>& clause) {
+    std::sort(clause.begin(), clause.end());
+}
+
+// splitmix64 finaliser
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+// Order-independent hash of XOR constraints; 0 when there are none, so
+// plain CNF keys are unchanged
+uint64_t xor_hash(const std::vector<XorConstraint>& xors) {
+    if (xors.empty()) {
+        return 0;
+    }
+    uint64_t sum = 0;
+    for (const auto& constraint : xors) {
+        uint64_t h = mix(constraint.variables.size() ^ (constraint.rhs ? 0x100000000ull : 0));
+        for (int var : constraint.variables) {
+            h = mix(h ^ static_cast<uint32_t>(var));
+        }
+        sum += mix(h);
+    }
+    return mix(sum ^ mix(xors.size() + 3));
+}
+
+} // namespace
+
 void Formula::normalize() {
     // Sort literals in each clause
     for (auto& clause : impl_->clauses) {
-        std::sort(clause.begin(), clause.end());
+        normalize_clause(clause);
     }
     // Sort clauses
     std::sort(impl_->clauses.begin(), impl_->clauses.end());
+    impl_->drop_staged_encoding();
+}
+
+uint64_t Formula::canonical_hash() const {
+    // Each normalized clause hashes on its own; summing the mixed clause
+    // hashes makes the result independent of clause order, so the clause
+    // list never needs sorting
+    uint64_t sum = 0;
+    if (impl_->structural) {
+        for (const auto& [x, y, z] : impl_->triplets) {
+            uint64_t h = mix(static_cast<uint32_t>(x));
+            h = mix(h ^ static_cast<uint32_t>(y));
+            sum += mix(h ^ static_cast<uint32_t>(z));
+        }
+        return mix(sum ^ mix(impl_->num_vars) ^ mix(impl_->triplets.size() + 2) ^ xor_hash(impl_->xors));
+    }
+    std::vector<int> clause;
+    for (const auto& original : impl_->clauses) {
+        clause = original;
+        normalize_clause(clause);
+        uint64_t h = mix(clause.size());
+        for (int lit : clause) {
+            h = mix(h ^ static_cast<uint32_t>(lit));
+        }
+        sum += mix(h);
+    }
+    return mix(sum ^ mix(impl_->num_vars) ^ mix(impl_->clauses.size() + 1) ^ xor_hash(impl_->xors));
 }
 
 size_t Formula::num_variables() const {
@@ -165,79 +433,334 @@ void Formula::translate_to_normalized_form() {
     }
     
     impl_->clauses = formula;
+    impl_->drop_staged_encoding();
+    impl_->encoded.store(false, std::memory_order_relaxed);
 }
 
-void Formula::encode_to_implication_triplets() {
-    // Validate the formula first
-    for (const auto& clause : impl_->clauses) {
-        for (int lit : clause) {
-            if (lit < -static_cast<int>(impl_->num_vars) || lit > static_cast<int>(impl_->num_vars) || lit == 0) {
-                // Invalid literal, but no printout needed
-            }
-        }
+namespace {
+
+// Below this many literals, starting threads costs more than it saves
+constexpr size_t PARALLEL_ENCODING_MIN_LITERALS = size_t{1} << 20;
+
+// Clauses are encoded from the last one down to clause 1, each chained to
+// the previous one's representative. The clause at position k of that
+// order gets representative num_vars + 2 + k and needs one triplet per
+// literal after the first, so where its triplets go depends only on k.
+size_t clause_triplet_count(const std::vector<int>& clause) {
+    size_t count = 0;
+    for (size_t j = 1; j < clause.size(); ++j) {
+        count += clause[j - 1] != 0;
     }
+    return count;
+}
 
-    // Clear any existing triplets
-    impl_->triplets.clear();
-   
-    // Assign a new variable for each compound subformula
-    int next_variable = static_cast<int>(impl_->num_vars) + 2;
-    int curr_rep = next_variable++; // New variable representing the current clause
-    int prev_rep = curr_rep - 1; // Variable representing the previous clause
-
-    // Process each clause
-    for (long unsigned int i = this->num_clauses() - 1; i > 0; i--) {
-        // Guard against out-of-bounds access
-        if (i >= this->num_clauses()) {
-            break;
+// Write the triplets of positions [begin, end) of the order, starting at out
+void encode_clause_block(const std::vector<std::vector<int>>& clauses, size_t num_vars,
+                         size_t begin, size_t end, std::tuple<int, int, int>* out) {
+    size_t last = clauses.size() - 1;
+    for (size_t k = begin; k < end; ++k) {
+        const std::vector<int>& clause = clauses[last - k];
+        int curr_rep = static_cast<int>(num_vars + 2 + k);
+        int prev_rep = curr_rep - 1;
+        if (clause.empty()) {
+            continue;
         }
-        
-        std::vector<int> curr_clause = this->impl_->clauses[i];
-        
-        // Process literals in the clause
-        for (unsigned int j = curr_clause.size() - 1; j > 0; j--) {
-            int prev_lit = curr_clause[j - 1];
-            int curr_lit = curr_clause[j];
-            
-            // Check for invalid literals
+        for (size_t j = clause.size() - 1; j > 0; j--) {
+            int prev_lit = clause[j - 1];
             if (prev_lit == 0) {
                 continue;
             }
+            // The last literal of the last clause ends the chain
+            int tail = (k == 0 && j == clause.size() - 1) ? clause[j] : prev_rep;
+            *out++ = std::make_tuple(curr_rep, prev_lit, tail);
+        }
+    }
+}
+
+} // namespace
+
+void Formula::set_encoding_threads(size_t threads) {
+    impl_->encoding_threads = threads;
+}
+
+void Formula::encode_new_clauses() {
+    TraceSpan span("encode clauses");
 
-            // Create triplets based on the clause structure - no normalization assumptions
-            if (j == curr_clause.size() - 1 && i == this->num_clauses() - 1) { 
-                // If the last element of the last clause
-                this->impl_->triplets.emplace_back(curr_rep, prev_lit, curr_lit);
+    // Clause i's triplets in clause order: the reverse of where the full
+    // encoding puts them, since that goes from the last clause down
+    const auto& clauses = impl_->clauses;
+    size_t first = std::max<size_t>(impl_->staged_clauses, 1);
+    size_t count = 0;
+    for (size_t i = first; i < clauses.size(); ++i) {
+        count += clause_triplet_count(clauses[i]);
+    }
+    impl_->staged_clauses = std::max(impl_->staged_clauses, clauses.size());
+    if (count == 0) {
+        return;
+    }
+    std::vector<std::tuple<int, int, int>> block;
+    block.reserve(count);
+    for (size_t i = first; i < clauses.size(); ++i) {
+        const auto& clause = clauses[i];
+        for (size_t j = 1; j < clause.size(); ++j) {
+            if (clause[j - 1] != 0) {
+                block.emplace_back(static_cast<int>(i), clause[j - 1], 0);
             }
-            else {
-                // For all other elements/clauses
-                this->impl_->triplets.emplace_back(curr_rep, prev_lit, prev_rep);
+        }
+    }
+    impl_->staged_blocks.push_back(std::move(block));
+    impl_->num_staged_triplets += count;
+}
+
+void Formula::encode_to_implication_triplets() {
+    TraceSpan span("encode");
+    const auto& clauses = impl_->clauses;
+
+    // Staged clauses only need their representatives, and to be written
+    // back to front
+    if (impl_->staged_clauses > 0) {
+        encode_new_clauses();
+        auto& triplets = impl_->triplets;
+        triplets.clear();
+        triplets.resize(impl_->num_staged_triplets);
+        size_t last = clauses.size() - 1;
+        int base = static_cast<int>(impl_->num_vars + 2 + last);
+        auto out = triplets.rbegin();
+        for (const auto& block : impl_->staged_blocks) {
+            for (const auto& [index, lit, unused] : block) {
+                int rep = base - index;
+                *out++ = std::make_tuple(rep, lit, rep - 1);
             }
         }
-        
-        prev_rep = curr_rep;
-        curr_rep++;
+        impl_->drop_staged_encoding();
+
+        // The last literal of the last clause ends the chain
+        const auto& tail = clauses[last];
+        if (last > 0 && tail.size() >= 2 && tail[tail.size() - 2] != 0) {
+            std::get<2>(triplets.front()) = tail.back();
+        }
+        impl_->bucket_triplets();
+        impl_->encoded.store(true, std::memory_order_release);
+        return;
+    }
+
+    size_t order_size = clauses.size() > 1 ? clauses.size() - 1 : 0;
+
+    // Prefix sum of triplet counts in encoding order: offsets[k] is where
+    // position k's triplets start
+    std::vector<size_t> offsets(order_size + 1, 0);
+    size_t num_literals = 0;
+    for (size_t k = 0; k < order_size; ++k) {
+        const auto& clause = clauses[clauses.size() - 1 - k];
+        offsets[k + 1] = offsets[k] + clause_triplet_count(clause);
+        num_literals += clause.size();
+    }
+
+    size_t threads = impl_->encoding_threads;
+    if (threads == 0) {
+        threads = num_literals < PARALLEL_ENCODING_MIN_LITERALS
+                      ? 1 : std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, std::max<size_t>(order_size, 1));
+
+    // Clear any existing triplets, keeping their storage
+    impl_->triplets.clear();
+    impl_->triplets.resize(offsets[order_size]);
+    std::tuple<int, int, int>* out = impl_->triplets.data();
+
+    if (threads <= 1) {
+        encode_clause_block(clauses, impl_->num_vars, 0, order_size, out);
+    } else {
+        // Blocks of roughly equal triplet counts, each writing its own slice
+        ThreadPool pool(threads);
+        size_t begin = 0;
+        for (size_t b = 1; b <= threads; ++b) {
+            size_t target = offsets[order_size] / threads * b;
+            size_t end = b == threads
+                ? order_size
+                : std::lower_bound(offsets.begin() + begin, offsets.end() - 1, target) - offsets.begin();
+            if (end > begin) {
+                pool.submit([&, begin, end](size_t) {
+                    encode_clause_block(clauses, impl_->num_vars, begin, end, out + offsets[begin]);
+                });
+            }
+            begin = end;
+        }
+        pool.wait();
+    }
+
+    impl_->bucket_triplets();
+    impl_->encoded.store(true, std::memory_order_release);
+}
+
+void Formula::reorder_for_locality() {
+    get_triplets();
+    auto& triplets = impl_->triplets;
+    if (triplets.empty()) {
+        return;
+    }
+
+    // Size the variable range, including the auxiliary variables
+    int num_vars = static_cast<int>(impl_->num_vars);
+    int max_var = num_vars;
+    for (const auto& [x, y, z] : triplets) {
+        max_var = std::max({max_var, std::abs(x), std::abs(y), std::abs(z)});
+    }
+
+    // Variable -> triplet incidence lists in CSR form
+    std::vector<int> offsets(max_var + 2, 0);
+    for (const auto& [x, y, z] : triplets) {
+        offsets[std::abs(x) + 1]++;
+        offsets[std::abs(y) + 1]++;
+        offsets[std::abs(z) + 1]++;
+    }
+    for (int v = 0; v <= max_var; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<int> incidence(offsets.back());
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triplets.size(); ++t) {
+        const auto& [x, y, z] = triplets[t];
+        incidence[fill[std::abs(x)]++] = static_cast<int>(t);
+        incidence[fill[std::abs(y)]++] = static_cast<int>(t);
+        incidence[fill[std::abs(z)]++] = static_cast<int>(t);
+    }
+    auto degree = [&offsets](int v) { return offsets[v + 1] - offsets[v]; };
+
+    // Cuthill-McKee: BFS from low-degree roots, neighbours by increasing degree
+    std::vector<int> roots;
+    for (int v = 1; v <= max_var; ++v) {
+        if (degree(v) > 0) {
+            roots.push_back(v);
+        }
+    }
+    std::stable_sort(roots.begin(), roots.end(),
+                     [&degree](int a, int b) { return degree(a) < degree(b); });
+
+    std::vector<char> visited(max_var + 1, 0);
+    std::vector<int> order;
+    order.reserve(max_var);
+    std::vector<int> neighbours;
+    for (int root : roots) {
+        if (visited[root]) {
+            continue;
+        }
+        visited[root] = 1;
+        size_t head = order.size();
+        order.push_back(root);
+        while (head < order.size()) {
+            int v = order[head++];
+            neighbours.clear();
+            for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+                const auto& [x, y, z] = triplets[incidence[i]];
+                for (int u : {std::abs(x), std::abs(y), std::abs(z)}) {
+                    if (u != 0 && !visited[u]) {
+                        visited[u] = 1;
+                        neighbours.push_back(u);
+                    }
+                }
+            }
+            std::stable_sort(neighbours.begin(), neighbours.end(),
+                             [&degree](int a, int b) { return degree(a) < degree(b); });
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+
+    // Renumber in visit order, keeping problem variables in 1..num_vars so
+    // the solver's branching range is unchanged
+    std::vector<int> new_index(max_var + 1, 0);
+    int next_original = 1;
+    int next_auxiliary = num_vars + 1;
+    for (int v : order) {
+        new_index[v] = (v <= num_vars) ? next_original++ : next_auxiliary++;
+    }
+    for (int v = 1; v <= max_var; ++v) {
+        if (!visited[v]) {
+            new_index[v] = (v <= num_vars) ? next_original++ : next_auxiliary++;
+        }
     }
+    auto rename = [&new_index](int lit) {
+        return lit < 0 ? -new_index[-lit] : new_index[lit];
+    };
+
+    for (auto& [x, y, z] : triplets) {
+        x = rename(x);
+        y = rename(y);
+        z = rename(z);
+    }
+    for (auto& clause : impl_->clauses) {
+        for (int& lit : clause) {
+            lit = rename(lit);
+        }
+    }
+    for (auto& constraint : impl_->xors) {
+        for (int& var : constraint.variables) {
+            var = rename(var);
+        }
+        std::sort(constraint.variables.begin(), constraint.variables.end());
+    }
+
+    // Sort triplets by their lowest variable so neighbouring triplets touch
+    // neighbouring assignment slots
+    auto lowest = [](const std::tuple<int, int, int>& t) {
+        return std::min({std::abs(std::get<0>(t)), std::abs(std::get<1>(t)), std::abs(std::get<2>(t))});
+    };
+    // Sort within each kind group; renaming never changes a triplet's kind
+    const TripletKindOffsets& groups = impl_->triplet_kind_offsets;
+    for (size_t k = 0; k < NUM_TRIPLET_KINDS; ++k) {
+        std::stable_sort(triplets.begin() + groups[k], triplets.begin() + groups[k + 1],
+                         [&lowest](const auto& a, const auto& b) { return lowest(a) < lowest(b); });
+    }
+
+    // Compose with any earlier reordering
+    std::vector<int> variable_map(max_var + 1);
+    for (int v = 0; v <= max_var; ++v) {
+        variable_map[new_index[v]] = original_variable(v);
+    }
+    impl_->variable_map = std::move(variable_map);
+    impl_->inverse_map.clear();
+    impl_->true_variable = impl_->true_variable != 0 ? rename(impl_->true_variable) : 0;
+    impl_->max_variable = 0;
+}
+
+int Formula::original_variable(int var) const {
+    if (var < 0 || static_cast<size_t>(var) >= impl_->variable_map.size()) {
+        return var;
+    }
+    return impl_->variable_map[var];
 }
 
 const std::vector<std::tuple<int, int, int>>& Formula::get_triplets() const {
-    // First, check if we already have triplets
-    if (impl_->triplets.empty()) {
-        // We need to modify the formula, but this is a const method
-        // We can use const_cast to temporarily remove const-ness
-        // This is generally not good practice, but can be justified here
-        // since we're maintaining logical constness (the external behavior doesn't change)
-        Formula* non_const_this = const_cast<Formula*>(this);
-        
-        // Skip translation to normalized form (which creates issues for CNF files)
-        // and directly encode the CNF clauses to triplets
-        non_const_this->encode_to_implication_triplets();
+    // Once encoded, readers only need the acquire load
+    if (impl_->encoded.load(std::memory_order_acquire)) {
+        return impl_->triplets;
+    }
+
+    // Double-checked: whoever takes the lock first encodes, the rest find
+    // the flag set
+    std::lock_guard<std::mutex> lock(impl_->encode_mutex);
+    if (!impl_->encoded.load(std::memory_order_relaxed)) {
+        if (impl_->structural) {
+            // Clauses added since are already appended as triplets
+            impl_->bucket_triplets();
+        } else {
+            // Encoding keeps logical constness: the formula means the same
+            // before and after. Skip translation to normalized form (which
+            // creates issues for CNF files) and encode the clauses directly,
+            // including any added since the last encoding
+            Formula* non_const_this = const_cast<Formula*>(this);
+            non_const_this->encode_to_implication_triplets();
+        }
+        impl_->encoded.store(true, std::memory_order_release);
     }
-    
-    // Now return the triplets
     return impl_->triplets;
 }
 
+const TripletKindOffsets& Formula::get_triplet_kind_offsets() const {
+    get_triplets();
+    return impl_->triplet_kind_offsets;
+}
+
 const std::vector<std::vector<int>>& Formula::get_clauses() const {
     return impl_->clauses;
 }
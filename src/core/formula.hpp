@@ -1,11 +1,37 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
+#include <tuple>
 
 namespace stalmarck {
 
+// Degenerate triplet shapes, fixed at encoding time. Triplets are stored
+// grouped by kind so propagation can run a specialised kernel per group.
+enum class TripletKind : uint8_t {
+    General,   // no repeated operand
+    XEqualsY,  // (x,x,z): rule 7 applies
+    YEqualsZ,  // (x,y,y): rule 4 applies
+    AllEqual   // (x,x,x): both
+};
+constexpr size_t NUM_TRIPLET_KINDS = 4;
+using TripletKindOffsets = std::array<size_t, NUM_TRIPLET_KINDS + 1>;
+
+TripletKind classify_triplet(int x, int y, int z);
+
+// Stable-sort triplets into kind groups and return the group boundaries
+TripletKindOffsets group_triplets_by_kind(std::vector<std::tuple<int, int, int>>& triplets);
+
+// Parity constraint: the variables XOR to rhs. Variables are sorted and
+// distinct
+struct XorConstraint {
+    std::vector<int> variables;
+    bool rhs = false;
+};
+
 class Formula {
 public:
     Formula();
@@ -16,12 +42,34 @@ public:
     Formula& operator=(const Formula&) = delete;
     
     // Add move operations
-    Formula(Formula&&) noexcept = default;
-    Formula& operator=(Formula&&) noexcept = default;
+    Formula(Formula&&) noexcept;
+    Formula& operator=(Formula&&) noexcept;
 
-    // Formula manipulation
+    // Formula manipulation. Clauses may be added after encoding: the next
+    // get_triplets() encodes them, and a structural formula takes them as
+    // triplets. Literals are in the original numbering
     void add_clause(const std::vector<int>& literals);
+    void add_clauses(const int* literals, size_t count); // DIMACS-style, 0-terminated clauses
+
+    // The XOR of these literals is true, as in DIMACS `x` lines. A repeated
+    // variable cancels out and a negated one flips the parity
+    void add_xor(const std::vector<int>& literals);
+    const std::vector<XorConstraint>& get_xors() const;
+
+    // Structural input, e.g. from a circuit: take these triplets, each
+    // x <-> (y -> z), as the whole formula instead of encoding clauses.
+    // Every variable in 1..num_variables is a problem variable. XOR
+    // constraints are kept.
+    void set_triplets(std::vector<std::tuple<int, int, int>> triplets, size_t num_variables);
+    bool is_structural() const;
     void normalize();
+
+    // Hash of the clause set in normalize()'s canonical form (literals
+    // sorted within each clause, clause order ignored) and the variable
+    // count, computed without reordering or sorting the clauses. A
+    // structural formula hashes its triplets, in any order, instead. XOR
+    // constraints are part of the key.
+    uint64_t canonical_hash() const;
     
     // Access methods
     size_t num_variables() const;
@@ -31,9 +79,28 @@ public:
     void translate_to_normalized_form();
     void encode_to_implication_triplets();
 
-    // Get triplets
+    // Threads for encode_to_implication_triplets: 1 encodes serially, 0
+    // (the default) uses every core once the formula is large enough to
+    // gain from it. The triplets come out the same either way
+    void set_encoding_threads(size_t threads);
+
+    // Encode the clauses added since the last call, for loaders that add
+    // clauses while still reading. The representatives depend on the final
+    // clause count, so this stages the triplets and the next encoding only
+    // fills them in; the triplets are the same as encoding in one go
+    void encode_new_clauses();
+
+    // Renumber variables and sort triplets for memory locality
+    void reorder_for_locality();
+    int original_variable(int var) const;
+
+    // Get triplets, encoding the clauses on first use. Safe to call from
+    // several threads at once, so solvers can share one const Formula
     const std::vector<std::tuple<int, int, int>>& get_triplets() const;
 
+    // Start of each kind's group in get_triplets(), plus the end
+    const TripletKindOffsets& get_triplet_kind_offsets() const;
+
     // Get clauses
     const std::vector<std::vector<int>>& get_clauses() const;
 
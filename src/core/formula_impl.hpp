@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <unordered_set>
 
@@ -7,10 +9,51 @@ namespace stalmarck {
 
 class Formula::Impl {
 public:
+    // Group the triplets by kind (stable within each group) and record the
+    // group boundaries
+    void bucket_triplets();
+
     std::vector<std::vector<int>> clauses;
+    std::vector<XorConstraint> xors;
     std::unordered_set<int> negated_clauses;
     std::vector<std::tuple<int, int, int>> triplets; 
+    TripletKindOffsets triplet_kind_offsets{};
     size_t num_vars = 0;
+    bool structural = false; // triplets given directly, no clauses to encode
+    std::vector<int> variable_map; // new index -> original index, empty if not reordered
+    std::vector<int> inverse_map;  // original problem variable -> new index, built on demand
+
+    // Literal in the current numbering for one in the original numbering
+    int current_literal(int lit);
+
+    // A clause added to a structural formula becomes triplets appended to
+    // the rest, l1 | ... | lk as true <-> (-l1 -> ... -> lk) as
+    // recover_gates encodes it. New problem variables push the auxiliary
+    // ones up, so problem variables stay 1..num_vars
+    void add_structural_clause(const std::vector<int>& literals);
+    int true_variable = 0; // auxiliary forced true, 0 until needed
+    int max_variable = 0;  // largest variable in the triplets, 0 until needed
+    size_t encoding_threads = 0;   // 0 = automatic
+
+    // Staged encoding (encode_new_clauses) of clauses [0, staged_clauses):
+    // one block per call, in clause order, with each triplet's clause index
+    // in place of its representative. Anything that rewrites clauses must
+    // drop it
+    std::vector<std::vector<std::tuple<int, int, int>>> staged_blocks;
+    size_t staged_clauses = 0;
+    size_t num_staged_triplets = 0;
+    void drop_staged_encoding() {
+        staged_blocks = {};
+        staged_clauses = 0;
+        num_staged_triplets = 0;
+    }
+
+    // get_triplets() encodes lazily: the first caller encodes under the
+    // mutex and publishes with a release store, so a const Formula can be
+    // shared by solvers on any number of threads. Changing the clauses
+    // clears the flag; that is not thread-safe, like any other mutation
+    std::atomic<bool> encoded{false};
+    std::mutex encode_mutex;
 };
 
 } // namespace stalmarck 
\ No newline at end of file
@@ -0,0 +1,340 @@
+#include "core/gates.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+namespace stalmarck {
+
+namespace {
+
+// ITE matching pairs up the ternary clauses of a literal, so very common
+// literals are skipped
+constexpr size_t MAX_ITE_OCCURRENCES = 64;
+
+constexpr uint32_t NO_CLAUSE = UINT32_MAX;
+
+// Clause order: by variable, then negative before positive
+bool literal_less(int a, int b) {
+    return std::abs(a) != std::abs(b) ? std::abs(a) < std::abs(b) : a < b;
+}
+
+// By variables, then signs, so ternary clauses over the same variables
+// end up adjacent
+bool ternary_less(const std::pair<std::array<int, 3>, uint32_t>& a,
+                  const std::pair<std::array<int, 3>, uint32_t>& b) {
+    const auto& p = a.first;
+    const auto& q = b.first;
+    return std::make_tuple(std::abs(p[0]), std::abs(p[1]), std::abs(p[2]), p[0], p[1], p[2]) <
+           std::make_tuple(std::abs(q[0]), std::abs(q[1]), std::abs(q[2]), q[0], q[1], q[2]);
+}
+
+size_t literal_index(int lit) {
+    return lit > 0 ? 2 * static_cast<size_t>(lit - 1) : 2 * static_cast<size_t>(-lit - 1) + 1;
+}
+
+class GateRecovery {
+public:
+    explicit GateRecovery(const Formula& formula) {
+        num_vars_ = static_cast<int>(formula.num_variables());
+        for (const auto& clause : formula.get_clauses()) {
+            add_clause(clause);
+        }
+        num_problem_vars_ = num_vars_;
+        occurrences_.resize(2 * static_cast<size_t>(num_vars_));
+        for (uint32_t i = 0; i < clauses_.size(); ++i) {
+            for (int lit : clauses_[i]) {
+                occurrences_[literal_index(lit)].push_back(i);
+            }
+            if (clauses_[i].size() == 3) {
+                ternary_.emplace_back(std::array<int, 3>{clauses_[i][0], clauses_[i][1], clauses_[i][2]}, i);
+            }
+        }
+        std::sort(ternary_.begin(), ternary_.end(), ternary_less);
+        used_.assign(clauses_.size(), 0);
+        partner_.assign(occurrences_.size(), NO_CLAUSE);
+    }
+
+    GateStats run(Formula& formula) {
+        find_and_gates();
+        find_xor_gates();
+        find_ite_gates();
+        encode_residual();
+        formula.set_triplets(std::move(triplets_), static_cast<size_t>(num_problem_vars_));
+        return stats_;
+    }
+
+private:
+    // Sorted and deduplicated; tautologies are dropped
+    void add_clause(const std::vector<int>& literals) {
+        std::vector<int> clause(literals);
+        std::sort(clause.begin(), clause.end(), literal_less);
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        for (size_t i = 1; i < clause.size(); ++i) {
+            if (clause[i] == -clause[i - 1]) {
+                return;
+            }
+        }
+        if (clause.empty()) {
+            refuted_ = true;
+            return;
+        }
+        num_vars_ = std::max(num_vars_, std::abs(clause.back()));
+        clauses_.push_back(std::move(clause));
+    }
+
+    uint32_t find_ternary(int a, int b, int c) const {
+        std::array<int, 3> key = {a, b, c};
+        std::sort(key.begin(), key.end(), literal_less);
+        auto it = std::lower_bound(ternary_.begin(), ternary_.end(), std::make_pair(key, uint32_t{0}), ternary_less);
+        return it != ternary_.end() && it->first == key ? it->second : NO_CLAUSE;
+    }
+
+    // Claim a gate's defining clauses; false when another gate already
+    // uses one of them
+    bool claim(const std::vector<uint32_t>& clauses) {
+        for (uint32_t i : clauses) {
+            if (used_[i]) {
+                return false;
+            }
+        }
+        for (uint32_t i : clauses) {
+            used_[i] = 1;
+        }
+        return true;
+    }
+
+    // g <-> (l1 & ... & lk) from (-g | li) for each i and (g | -l1 | ... | -lk).
+    // With g negated this is an OR gate.
+    void find_and_gates() {
+        std::vector<uint32_t> defining;
+        std::vector<int> inputs;
+        for (int var = 1; var <= num_problem_vars_; ++var) {
+            for (int g : {var, -var}) {
+                // Literals l with a binary clause (-g | l)
+                std::vector<size_t> marked;
+                for (uint32_t i : occurrences_[literal_index(-g)]) {
+                    if (clauses_[i].size() == 2) {
+                        int l = clauses_[i][0] == -g ? clauses_[i][1] : clauses_[i][0];
+                        partner_[literal_index(l)] = i;
+                        marked.push_back(literal_index(l));
+                    }
+                }
+                if (marked.size() < 2) {
+                    for (size_t m : marked) {
+                        partner_[m] = NO_CLAUSE;
+                    }
+                    continue;
+                }
+                for (uint32_t base : occurrences_[literal_index(g)]) {
+                    const auto& clause = clauses_[base];
+                    if (clause.size() < 3) {
+                        continue;
+                    }
+                    defining.assign(1, base);
+                    inputs.clear();
+                    for (int m : clause) {
+                        if (m == g) {
+                            continue;
+                        }
+                        uint32_t binary = partner_[literal_index(-m)];
+                        if (binary == NO_CLAUSE) {
+                            break;
+                        }
+                        defining.push_back(binary);
+                        inputs.push_back(-m);
+                    }
+                    if (inputs.size() + 1 == clause.size() && claim(defining)) {
+                        encode_and(g, inputs);
+                        stats_.and_gates++;
+                    }
+                }
+                for (size_t m : marked) {
+                    partner_[m] = NO_CLAUSE;
+                }
+            }
+        }
+    }
+
+    // x <-> (a ^ b): the four ternary clauses over {x, a, b} whose number
+    // of negations has the same parity. The highest variable is taken as
+    // the output.
+    void find_xor_gates() {
+        for (size_t begin = 0; begin < ternary_.size();) {
+            auto vars = [this](size_t i) {
+                const auto& c = ternary_[i].first;
+                return std::make_tuple(std::abs(c[0]), std::abs(c[1]), std::abs(c[2]));
+            };
+            size_t end = begin + 1;
+            while (end < ternary_.size() && vars(end) == vars(begin)) {
+                end++;
+            }
+            std::array<uint32_t, 8> by_signs;
+            by_signs.fill(NO_CLAUSE);
+            for (size_t i = begin; i < end; ++i) {
+                const auto& c = ternary_[i].first;
+                unsigned signs = (c[0] < 0 ? 1u : 0u) | (c[1] < 0 ? 2u : 0u) | (c[2] < 0 ? 4u : 0u);
+                by_signs[signs] = ternary_[i].second;
+            }
+            auto [a, b, x] = vars(begin);
+            for (unsigned parity : {1u, 0u}) {
+                std::vector<uint32_t> defining;
+                for (unsigned signs = 0; signs < 8; ++signs) {
+                    if (((signs ^ (signs >> 1) ^ (signs >> 2)) & 1u) == parity &&
+                        by_signs[signs] != NO_CLAUSE) {
+                        defining.push_back(by_signs[signs]);
+                    }
+                }
+                // Odd negation counts exclude x ^ a ^ b = 1
+                if (defining.size() == 4 && claim(defining)) {
+                    encode_xor(parity == 1 ? x : -x, a, b);
+                    stats_.xor_gates++;
+                }
+            }
+            begin = end;
+        }
+    }
+
+    // x <-> (c ? t : e) from (-x | -c | t), (-x | c | e), (x | -c | -t)
+    // and (x | c | -e)
+    void find_ite_gates() {
+        for (int x = 1; x <= num_problem_vars_; ++x) {
+            std::vector<uint32_t> negative;
+            for (uint32_t i : occurrences_[literal_index(-x)]) {
+                if (clauses_[i].size() == 3) {
+                    negative.push_back(i);
+                }
+            }
+            if (negative.size() < 2 || negative.size() > MAX_ITE_OCCURRENCES) {
+                continue;
+            }
+            for (uint32_t first : negative) {
+                for (uint32_t second : negative) {
+                    if (first == second) {
+                        continue;
+                    }
+                    auto others = [this, x](uint32_t i) {
+                        std::array<int, 2> rest{};
+                        size_t n = 0;
+                        for (int lit : clauses_[i]) {
+                            if (lit != -x) {
+                                rest[n++] = lit;
+                            }
+                        }
+                        return rest;
+                    };
+                    auto p = others(first);
+                    auto q = others(second);
+                    for (size_t i = 0; i < 2; ++i) {
+                        for (size_t j = 0; j < 2; ++j) {
+                            if (p[i] != -q[j]) {
+                                continue;
+                            }
+                            int c = q[j];
+                            int t = p[1 - i];
+                            int e = q[1 - j];
+                            uint32_t third = find_ternary(x, -c, -t);
+                            uint32_t fourth = find_ternary(x, c, -e);
+                            if (third != NO_CLAUSE && fourth != NO_CLAUSE &&
+                                claim({first, second, third, fourth})) {
+                                encode_ite(x, c, t, e);
+                                stats_.ite_gates++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int fresh_variable() {
+        return ++num_vars_;
+    }
+
+    // A variable forced true, heading the residual clauses' chains
+    int true_variable() {
+        if (true_var_ == 0) {
+            true_var_ = fresh_variable();
+            triplets_.emplace_back(true_var_, true_var_, true_var_);
+        }
+        return true_var_;
+    }
+
+    // -out <-> (acc -> -in) is out <-> (acc & in), folded left to right
+    void encode_and(int g, const std::vector<int>& inputs) {
+        int acc = inputs[0];
+        for (size_t i = 1; i < inputs.size(); ++i) {
+            int out = i + 1 == inputs.size() ? g : fresh_variable();
+            triplets_.emplace_back(-out, acc, -inputs[i]);
+            acc = out;
+        }
+    }
+
+    // x <-> (a ^ b) is x <-> ((a -> b) -> -(b -> a))
+    void encode_xor(int x, int a, int b) {
+        int p = fresh_variable();
+        int q = fresh_variable();
+        triplets_.emplace_back(p, a, b);
+        triplets_.emplace_back(q, b, a);
+        triplets_.emplace_back(x, p, -q);
+    }
+
+    // x <-> ((c -> t) & (-c -> e))
+    void encode_ite(int x, int c, int t, int e) {
+        int p = fresh_variable();
+        int q = fresh_variable();
+        triplets_.emplace_back(p, c, t);
+        triplets_.emplace_back(q, -c, e);
+        triplets_.emplace_back(-x, p, -q);
+    }
+
+    // l1 | ... | lk as true <-> (-l1 -> (-l2 -> ... -> lk)); units are
+    // asserted directly
+    void encode_residual() {
+        for (uint32_t i = 0; i < clauses_.size(); ++i) {
+            if (used_[i]) {
+                continue;
+            }
+            const auto& clause = clauses_[i];
+            stats_.residual_clauses++;
+            if (clause.size() == 1) {
+                triplets_.emplace_back(clause[0], clause[0], clause[0]);
+                continue;
+            }
+            int rest = clause.back();
+            for (size_t j = clause.size() - 2; j > 0; --j) {
+                int v = fresh_variable();
+                triplets_.emplace_back(v, -clause[j], rest);
+                rest = v;
+            }
+            triplets_.emplace_back(true_variable(), -clause[0], rest);
+        }
+        if (refuted_) {
+            int t = true_variable();
+            triplets_.emplace_back(-t, -t, -t);
+        }
+    }
+
+    int num_problem_vars_ = 0; // the variables gates are looked for among
+    int num_vars_ = 0;         // grows with auxiliary variables
+    bool refuted_ = false; // an empty clause was seen
+    int true_var_ = 0;
+    std::vector<std::vector<int>> clauses_;
+    std::vector<std::vector<uint32_t>> occurrences_;                // literal index -> clauses
+    std::vector<std::pair<std::array<int, 3>, uint32_t>> ternary_; // sorted, for lookup
+    std::vector<uint8_t> used_;                                     // clause belongs to a gate
+    std::vector<uint32_t> partner_;                                 // scratch for find_and_gates
+    std::vector<std::tuple<int, int, int>> triplets_;
+    GateStats stats_;
+};
+
+} // namespace
+
+GateStats recover_gates(Formula& formula) {
+    GateRecovery recovery(formula);
+    return recovery.run(formula);
+}
+
+} // namespace stalmarck
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "formula.hpp"
+#include <cstddef>
+
+namespace stalmarck {
+
+// Counts from the last recover_gates call
+struct GateStats {
+    size_t and_gates = 0;        // x <-> (a & b & ...), ORs included
+    size_t xor_gates = 0;        // x <-> (a ^ b)
+    size_t ite_gates = 0;        // x <-> (c ? t : e)
+    size_t residual_clauses = 0; // clauses no gate accounts for
+};
+
+// Find gate definitions among the clauses by matching their Tseitin clause
+// patterns on the occurrence lists, and turn the formula into a structural
+// one (see Formula::set_triplets): each recovered gate becomes one to three
+// native triplets, and every other clause l1 | ... | lk an implication
+// chain -l1 -> ... -> lk headed by a variable forced true.
+//
+// A gate replaces exactly the clauses it was matched from, which are
+// equivalent to it, so the result has the same models over the original
+// variables. Variables keep their numbers; auxiliary variables follow them.
+// Call before the formula is solved.
+GateStats recover_gates(Formula& formula);
+
+} // namespace stalmarck
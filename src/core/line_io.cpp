@@ -0,0 +1,80 @@
+#include "core/line_io.hpp"
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace stalmarck {
+
+bool LineReader::fill() {
+    char chunk[4096];
+    ssize_t n;
+    do {
+        n = ::read(fd_, chunk, sizeof(chunk));
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    buffer_.append(chunk, static_cast<size_t>(n));
+    return true;
+}
+
+bool LineReader::next_line(std::string& line) {
+    size_t newline = buffer_.find('\n');
+    if (newline == std::string::npos) {
+        return false;
+    }
+    line.assign(buffer_, 0, newline);
+    buffer_.erase(0, newline + 1);
+    return true;
+}
+
+bool LineReader::read_line(std::string& line) {
+    while (!next_line(line)) {
+        if (!fill()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool write_all(int fd, const std::string& data, bool is_socket) {
+    size_t written = 0;
+    while (written < data.size()) {
+        // The writer must survive a peer that died mid-write
+        ssize_t n = is_socket
+            ? ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL)
+            : ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool parse_literals(std::istringstream& in, std::vector<int>& literals) {
+    literals.clear();
+    int lit;
+    while (in >> lit) {
+        if (lit == 0) {
+            return true;
+        }
+        literals.push_back(lit);
+    }
+    return false;
+}
+
+std::string format_literals(const char* tag, const std::vector<int>& literals) {
+    std::string line = tag;
+    for (int lit : literals) {
+        line += ' ';
+        line += std::to_string(lit);
+    }
+    line += " 0\n";
+    return line;
+}
+
+} // namespace stalmarck
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stalmarck {
+
+// Line-protocol helpers shared by the cube workers and the solver service
+
+// Buffered line reader over a file descriptor
+class LineReader {
+public:
+    explicit LineReader(int fd) : fd_(fd) {}
+
+    // One read() into the buffer; false at end of input or on error
+    bool fill();
+
+    // Next complete line already in the buffer, without the newline
+    bool next_line(std::string& line);
+
+    // Blocking read of the next line
+    bool read_line(std::string& line);
+
+private:
+    int fd_;
+    std::string buffer_;
+};
+
+// Write everything; sockets are written without raising SIGPIPE
+bool write_all(int fd, const std::string& data, bool is_socket);
+
+// "<tag> <lit> ... 0" -> the literals after the tag
+bool parse_literals(std::istringstream& in, std::vector<int>& literals);
+
+std::string format_literals(const char* tag, const std::vector<int>& literals);
+
+} // namespace stalmarck
@@ -0,0 +1,103 @@
+#include "core/perf_counters.hpp"
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace stalmarck {
+
+namespace {
+
+// Slots of PerfCounters::fds_, in PhaseCounters order
+int64_t PhaseCounters::* const counter_fields[] = {
+    &PhaseCounters::cycles,
+    &PhaseCounters::instructions,
+    &PhaseCounters::l1d_misses,
+    &PhaseCounters::llc_misses,
+    &PhaseCounters::branch_misses,
+};
+
+#ifdef __linux__
+int open_counter(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = type;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+} // namespace
+
+PhaseCounters phase_difference(const PhaseCounters& after, const PhaseCounters& before) {
+    PhaseCounters result;
+    result.seconds = after.seconds - before.seconds;
+    for (auto field : counter_fields) {
+        if (after.*field >= 0 && before.*field >= 0) {
+            result.*field = after.*field - before.*field;
+        }
+    }
+    return result;
+}
+
+PerfCounters::PerfCounters() {
+    for (int& fd : fds_) {
+        fd = -1;
+    }
+#ifdef __linux__
+    fds_[0] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds_[1] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds_[2] = open_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                               (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    fds_[3] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    fds_[4] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    start_ = std::chrono::steady_clock::now();
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::available() const {
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PhaseCounters PerfCounters::read() const {
+    PhaseCounters counters;
+    counters.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+#ifdef __linux__
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+        uint64_t values[3]; // value, time enabled, time running
+        if (fds_[i] < 0 || ::read(fds_[i], values, sizeof(values)) != sizeof(values)) {
+            continue;
+        }
+        double scale = values[2] > 0 && values[2] < values[1]
+            ? static_cast<double>(values[1]) / static_cast<double>(values[2]) : 1.0;
+        counters.*counter_fields[i] = static_cast<int64_t>(static_cast<double>(values[0]) * scale);
+    }
+#endif
+    return counters;
+}
+
+} // namespace stalmarck
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace stalmarck {
+
+// Wall time and hardware event counts of one phase. A count is -1 when its
+// counter is unavailable
+struct PhaseCounters {
+    double seconds = 0.0;
+    int64_t cycles = -1;
+    int64_t instructions = -1;
+    int64_t l1d_misses = -1;    // L1 data cache read misses
+    int64_t llc_misses = -1;    // last-level cache misses
+    int64_t branch_misses = -1;
+};
+
+// after - before, for the counts both have
+PhaseCounters phase_difference(const PhaseCounters& after, const PhaseCounters& before);
+
+// Hardware counters for the calling thread and the threads it starts while
+// counting, in user space, via Linux perf_event_open. Counting starts at
+// construction and read() takes a snapshot, so phases are differences of
+// snapshots. Counters the kernel refuses (containers, perf_event_paranoid,
+// no PMU, not Linux) read -1, leaving just the time. Counts are scaled up
+// when the kernel multiplexed the counters.
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const; // at least one hardware counter is counting
+
+    PhaseCounters read() const;
+
+private:
+    static constexpr size_t NUM_COUNTERS = 5;
+    int fds_[NUM_COUNTERS];
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace stalmarck
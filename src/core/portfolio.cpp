@@ -0,0 +1,172 @@
+#include "core/portfolio.hpp"
+#include "solver/solver.hpp"
+#include "solver/exchange.hpp"
+#include "solver/local_search.hpp"
+#include "core/trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace stalmarck {
+
+namespace {
+
+// Portfolio member i: four search styles, then the same four with the
+// opposite branching phase
+struct MemberConfig {
+    bool lookahead;
+    bool inprocess;
+    bool phase;
+
+    explicit MemberConfig(size_t i)
+        : lookahead(i % 4 == 1 || i % 4 == 3),
+          inprocess(i % 4 == 2 || i % 4 == 3),
+          phase((i / 4) % 2 == 0) {}
+
+    void apply(Solver& solver) const {
+        solver.set_lookahead(lookahead ? 8 : 0);
+        solver.set_inprocessing(inprocess);
+        solver.set_phase(phase);
+    }
+
+    std::string name() const {
+        std::string style = lookahead && inprocess ? "lookahead+inprocess"
+                          : lookahead ? "lookahead"
+                          : inprocess ? "inprocess"
+                          : "plain";
+        return style + (phase ? "/true-first" : "/false-first");
+    }
+};
+
+} // namespace
+
+class PortfolioSolver::Impl {
+public:
+    size_t threads = 0;
+    double timeout = 0.0;
+    bool sharing = true;
+    size_t max_shared_clause = 3;
+    bool local_search = false;
+
+    SolveStatus status = SolveStatus::UNKNOWN;
+    std::vector<int> model;
+    std::string winner;
+    uint64_t shared_facts = 0;
+};
+
+PortfolioSolver::PortfolioSolver() : impl_(std::make_unique<Impl>()) {}
+PortfolioSolver::~PortfolioSolver() = default;
+
+void PortfolioSolver::set_threads(size_t threads) {
+    impl_->threads = threads;
+}
+
+void PortfolioSolver::set_timeout(double seconds) {
+    impl_->timeout = seconds;
+}
+
+void PortfolioSolver::set_sharing(bool enabled) {
+    impl_->sharing = enabled;
+}
+
+void PortfolioSolver::set_max_shared_clause(size_t size) {
+    impl_->max_shared_clause = size;
+}
+
+void PortfolioSolver::set_local_search(bool enabled) {
+    impl_->local_search = enabled;
+}
+
+bool PortfolioSolver::solve(const Formula& formula) {
+    impl_->status = SolveStatus::UNKNOWN;
+    impl_->model.clear();
+    impl_->winner.clear();
+
+    size_t num_threads = impl_->threads;
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The members share the formula read-only; the first to need the
+    // triplets encodes them
+
+    FactExchange exchange;
+    std::atomic<bool> stop{false};
+    std::mutex result_mutex;
+    std::vector<std::thread> members;
+
+    // The local search member takes the last thread
+    size_t num_complete = num_threads;
+    if (impl_->local_search) {
+        num_complete = std::max<size_t>(num_threads - 1, 1);
+        members.emplace_back([&, num_complete] {
+            set_trace_thread_name("portfolio local search");
+            LocalSearch search;
+            search.set_seed(num_complete + 1);
+            search.set_timeout(impl_->timeout);
+            search.set_stop_flag(&stop);
+            if (!search.solve(formula)) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(result_mutex);
+            if (impl_->winner.empty()) {
+                impl_->status = SolveStatus::SAT;
+                impl_->model = search.get_model();
+                impl_->winner = "local search";
+                stop.store(true, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (size_t i = 0; i < num_complete; ++i) {
+        members.emplace_back([&, i] {
+            MemberConfig config(i);
+            set_trace_thread_name("portfolio " + config.name());
+            Solver solver;
+            config.apply(solver);
+            solver.set_timeout(impl_->timeout);
+            solver.set_stop_flag(&stop);
+            if (impl_->sharing) {
+                solver.set_exchange(&exchange, static_cast<uint16_t>(i), impl_->max_shared_clause);
+            }
+
+            bool satisfiable = solver.solve(formula);
+            if (solver.is_interrupted()) {
+                return;
+            }
+
+            // First finished member answers and stops the others
+            std::lock_guard<std::mutex> lock(result_mutex);
+            if (impl_->winner.empty()) {
+                impl_->status = satisfiable ? SolveStatus::SAT : SolveStatus::UNSAT;
+                impl_->model = solver.get_model();
+                impl_->winner = config.name();
+                stop.store(true, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& member : members) {
+        member.join();
+    }
+
+    impl_->shared_facts = exchange.published();
+    return true;
+}
+
+SolveStatus PortfolioSolver::get_status() const {
+    return impl_->status;
+}
+
+const std::vector<int>& PortfolioSolver::get_model() const {
+    return impl_->model;
+}
+
+std::string PortfolioSolver::get_winner() const {
+    return impl_->winner;
+}
+
+uint64_t PortfolioSolver::shared_facts() const {
+    return impl_->shared_facts;
+}
+
+} // namespace stalmarck
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "stalmarck.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stalmarck {
+
+// Threaded portfolio: several differently configured solvers race on one
+// formula and the first answer wins. With sharing on, the solvers exchange
+// units, equivalences and short refuted decision paths through a lock-free
+// FactExchange, so each one stops rediscovering what another already knows.
+class PortfolioSolver {
+public:
+    PortfolioSolver();
+    ~PortfolioSolver();
+
+    // Configuration methods
+    void set_threads(size_t threads);       // 0 = hardware concurrency
+    void set_timeout(double seconds);       // 0 = none
+    void set_sharing(bool enabled);         // default on
+    void set_max_shared_clause(size_t size); // longest shared clause, default 3
+
+    // Give one thread to local search (see LocalSearch), which can only
+    // answer SAT; with a single thread it runs alongside. Default off
+    void set_local_search(bool enabled);
+
+    bool solve(const Formula& formula);
+    SolveStatus get_status() const;
+    const std::vector<int>& get_model() const;
+
+    // Which configuration answered, e.g. "lookahead+inprocess/false-first"
+    // or "local search"
+    std::string get_winner() const;
+    uint64_t shared_facts() const; // facts published during the last solve
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace stalmarck
@@ -0,0 +1,176 @@
+#include "core/result_cache.hpp"
+#include "core/line_io.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#ifndef STALMARCK_VERSION
+#define STALMARCK_VERSION "unknown"
+#endif
+
+namespace stalmarck {
+
+namespace {
+
+constexpr const char* entry_magic = "stalmarck-result 1";
+
+// Whole contents of an open file
+bool read_fd(int fd, std::string& contents) {
+    char chunk[4096];
+    ssize_t n;
+    contents.clear();
+    while ((n = ::read(fd, chunk, sizeof(chunk))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        contents.append(chunk, static_cast<size_t>(n));
+    }
+    return true;
+}
+
+// splitmix64 finaliser
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+} // namespace
+
+class ResultCache::Impl {
+public:
+    std::string directory;
+    std::string error_message;
+    bool has_error_flag = false;
+    mutable std::mutex error_mutex; // batch workers store concurrently
+
+    std::string entry_path(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.result", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(directory) / name).string();
+    }
+
+    bool fail(const std::string& message) {
+        std::string reason = std::strerror(errno);
+        std::lock_guard<std::mutex> lock(error_mutex);
+        error_message = message + ": " + reason;
+        has_error_flag = true;
+        return false;
+    }
+};
+
+ResultCache::ResultCache(const std::string& directory) : impl_(std::make_unique<Impl>()) {
+    impl_->directory = directory;
+}
+
+ResultCache::~ResultCache() = default;
+
+std::string ResultCache::solver_version() {
+    return STALMARCK_VERSION;
+}
+
+uint64_t ResultCache::key(uint64_t formula_hash, bool symmetry, size_t symmetry_prefix,
+                          bool xors, bool gates) {
+    if (!symmetry && !xors && !gates) {
+        return formula_hash;
+    }
+    uint64_t options = (symmetry ? 1 : 0) | (xors ? 2 : 0) | (gates ? 4 : 0);
+    if (symmetry) {
+        options |= static_cast<uint64_t>(symmetry_prefix) << 3;
+    }
+    return mix(formula_hash ^ mix(options));
+}
+
+bool ResultCache::lookup(uint64_t key, CachedResult& result) const {
+    int fd = ::open(impl_->entry_path(key).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    std::string contents;
+    bool read = ::flock(fd, LOCK_SH) == 0 && read_fd(fd, contents);
+    ::close(fd);
+    if (!read) {
+        return false;
+    }
+
+    // An entry still being written, or from another version, is a miss
+    std::istringstream in(contents);
+    std::string line, tag, status;
+    if (!std::getline(in, line) || line != entry_magic) {
+        return false;
+    }
+    if (!(in >> tag >> result.version) || tag != "version" || result.version != solver_version()) {
+        return false;
+    }
+    if (!(in >> tag >> status) || tag != "status") {
+        return false;
+    }
+    if (status == "UNSAT") {
+        result.status = SolveStatus::UNSAT;
+        result.model.clear();
+        return true;
+    }
+    if (status != "SAT" || !(in >> tag) || tag != "model" || !parse_literals(in, result.model)) {
+        return false;
+    }
+    result.status = SolveStatus::SAT;
+    return true;
+}
+
+bool ResultCache::store(uint64_t key, SolveStatus status, const std::vector<int>& model) {
+    if (status == SolveStatus::UNKNOWN) {
+        return true;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(impl_->directory, ec);
+    if (ec) {
+        errno = ec.value();
+        return impl_->fail("Could not create cache directory " + impl_->directory);
+    }
+
+    std::string contents = std::string(entry_magic) + "\nversion " + solver_version() + "\n";
+    if (status == SolveStatus::SAT) {
+        contents += "status SAT\n" + format_literals("model", model);
+    } else {
+        contents += "status UNSAT\n";
+    }
+
+    // Truncate only once the exclusive lock is held, so readers never see
+    // a half-written entry
+    std::string path = impl_->entry_path(key);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return impl_->fail("Could not open " + path);
+    }
+    bool written = ::flock(fd, LOCK_EX) == 0 && ::ftruncate(fd, 0) == 0 &&
+                   write_all(fd, contents, false);
+    ::close(fd);
+    if (!written) {
+        return impl_->fail("Could not write " + path);
+    }
+    return true;
+}
+
+bool ResultCache::has_error() const {
+    std::lock_guard<std::mutex> lock(impl_->error_mutex);
+    return impl_->has_error_flag;
+}
+
+std::string ResultCache::get_error() const {
+    std::lock_guard<std::mutex> lock(impl_->error_mutex);
+    return impl_->error_message;
+}
+
+} // namespace stalmarck
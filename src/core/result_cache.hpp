@@ -0,0 +1,52 @@
+#pragma once
+
+#include "stalmarck.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stalmarck {
+
+// A finished solve as kept in the result cache
+struct CachedResult {
+    SolveStatus status = SolveStatus::UNKNOWN;
+    std::vector<int> model;  // SAT only, as StalmarckSolver::get_model()
+    std::string version;     // solver version that produced it
+};
+
+// Persistent on-disk cache of SAT/UNSAT answers, keyed by
+// Formula::canonical_hash() and the preprocessing options (see key()). One file per entry; readers take a shared
+// flock and writers an exclusive one, so several processes can share a
+// directory, and one cache may be used from several threads. Entries
+// written by another solver version read as misses.
+class ResultCache {
+public:
+    explicit ResultCache(const std::string& directory);
+    ~ResultCache();
+
+    // False on a miss or an unreadable entry
+    bool lookup(uint64_t key, CachedResult& result) const;
+
+    // UNKNOWN results are not stored; false and sets the error if the
+    // entry could not be written
+    bool store(uint64_t key, SolveStatus status, const std::vector<int>& model);
+
+    static std::string solver_version();
+
+    // Key for a formula solved after the given preprocessing, which
+    // changes what is solved and so can change the stored answer. Without
+    // any, this is the formula's own canonical_hash()
+    static uint64_t key(uint64_t formula_hash, bool symmetry, size_t symmetry_prefix,
+                        bool xors, bool gates);
+
+    // Error handling
+    bool has_error() const;
+    std::string get_error() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace stalmarck
@@ -0,0 +1,441 @@
+#include "core/server.hpp"
+#include "core/line_io.hpp"
+#include "core/thread_pool.hpp"
+#include "parser/parser.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace stalmarck {
+
+uint64_t content_hash(const std::string& data) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+class FormulaCache::Impl {
+public:
+    using Entry = std::pair<uint64_t, std::shared_ptr<const Formula>>;
+
+    size_t capacity;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    mutable std::mutex mutex;
+};
+
+FormulaCache::FormulaCache(size_t capacity) : impl_(std::make_unique<Impl>()) {
+    impl_->capacity = capacity;
+}
+
+FormulaCache::~FormulaCache() = default;
+
+std::shared_ptr<const Formula> FormulaCache::get(uint64_t key) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->index.find(key);
+    if (it == impl_->index.end()) {
+        return nullptr;
+    }
+    impl_->entries.splice(impl_->entries.begin(), impl_->entries, it->second);
+    return it->second->second;
+}
+
+void FormulaCache::put(uint64_t key, std::shared_ptr<const Formula> formula) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (impl_->capacity == 0) {
+        return;
+    }
+    auto it = impl_->index.find(key);
+    if (it != impl_->index.end()) {
+        it->second->second = std::move(formula);
+        impl_->entries.splice(impl_->entries.begin(), impl_->entries, it->second);
+        return;
+    }
+    if (impl_->entries.size() >= impl_->capacity) {
+        impl_->index.erase(impl_->entries.back().first);
+        impl_->entries.pop_back();
+    }
+    impl_->entries.emplace_front(key, std::move(formula));
+    impl_->index[key] = impl_->entries.begin();
+}
+
+size_t FormulaCache::size() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->entries.size();
+}
+
+size_t FormulaCache::capacity() const {
+    return impl_->capacity;
+}
+
+namespace {
+
+// One solve request, as read from a connection
+struct Request {
+    double timeout = 0.0;
+    size_t lookahead = 0;
+    bool inprocess = false;
+    bool compact = false;
+    bool is_inline = false;
+    std::string path;  // file requests
+    std::string text;  // inline requests
+};
+
+// Options and source of a "solve" line; false and sets error if malformed
+bool parse_request(std::istringstream& in, Request& request, std::string& error) {
+    std::string word;
+    while (in >> word) {
+        if (word == "timeout" && in >> request.timeout) {
+            continue;
+        } else if (word == "lookahead" && in >> request.lookahead) {
+            continue;
+        } else if (word == "inprocess") {
+            request.inprocess = true;
+        } else if (word == "compact") {
+            request.compact = true;
+        } else if (word == "inline") {
+            request.is_inline = true;
+            return true;
+        } else if (word == "file") {
+            // The rest of the line is the path, which may hold spaces
+            std::getline(in >> std::ws, request.path);
+            if (request.path.empty()) {
+                error = "missing path";
+                return false;
+            }
+            return true;
+        } else {
+            error = "bad option: " + word;
+            return false;
+        }
+    }
+    error = "missing file or inline";
+    return false;
+}
+
+// A client connection; busy while one of its requests is on the pool
+struct Connection {
+    explicit Connection(int fd) : fd(fd), reader(fd) {}
+
+    int fd;
+    LineReader reader;
+    std::atomic<bool> busy{false};
+    bool closed = false;         // the client hung up
+    bool reading_inline = false; // collecting DIMACS lines until "end"
+    Request pending;
+};
+
+} // namespace
+
+class SolverServer::Impl {
+public:
+    size_t workers = 0;
+    size_t cache_size = 64;
+    double max_timeout = 0.0;
+
+    std::string socket_path;
+    int listen_fd = -1;
+    int wake_pipe[2] = {-1, -1}; // written by stop() and finished requests
+    std::atomic<bool> stopping{false};
+
+    std::unique_ptr<FormulaCache> cache;
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+
+    std::string error_message;
+    bool has_error_flag = false;
+
+    bool fail(const std::string& message) {
+        error_message = message + ": " + std::strerror(errno);
+        has_error_flag = true;
+        return false;
+    }
+
+    void wake() {
+        char byte = 0;
+        ssize_t written = ::write(wake_pipe[1], &byte, 1);
+        (void)written; // a full pipe already holds a wake-up
+    }
+
+    void close_all() {
+        for (int* fd : {&listen_fd, &wake_pipe[0], &wake_pipe[1]}) {
+            if (*fd >= 0) {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+    }
+
+    std::string stats_line() const {
+        return "STATS requests " + std::to_string(requests.load()) +
+               " hits " + std::to_string(hits.load()) +
+               " misses " + std::to_string(misses.load()) +
+               " cached " + std::to_string(cache->size()) + "\n";
+    }
+
+    // Cached formula for the request's DIMACS text, parsing and encoding it on a miss
+    std::shared_ptr<const Formula> load(const Request& request, Parser& parser, std::string& error) {
+        std::string text = request.text;
+        if (!request.is_inline) {
+            std::ifstream file(request.path, std::ios::binary);
+            if (!file.is_open()) {
+                error = "Could not open file: " + request.path;
+                return nullptr;
+            }
+            std::ostringstream contents;
+            contents << file.rdbuf();
+            text = contents.str();
+        }
+
+        uint64_t key = content_hash(text);
+        if (auto formula = cache->get(key)) {
+            hits++;
+            return formula;
+        }
+        misses++;
+        Formula parsed = parser.parse_dimacs_string(text);
+        if (parser.has_error()) {
+            error = parser.get_error();
+            return nullptr;
+        }
+        // Shared as it is: whichever connection solves it first encodes it
+        auto formula = std::make_shared<const Formula>(std::move(parsed));
+        cache->put(key, formula);
+        return formula;
+    }
+
+    std::string handle(const Request& request, StalmarckSolver& solver, Parser& parser) {
+        std::string error;
+        std::shared_ptr<const Formula> formula = load(request, parser, error);
+        if (!formula) {
+            return "ERROR " + error + "\n";
+        }
+
+        double timeout = request.timeout;
+        if (max_timeout > 0.0 && (timeout <= 0.0 || timeout > max_timeout)) {
+            timeout = max_timeout;
+        }
+        solver.set_timeout(timeout);
+        solver.set_lookahead(request.lookahead, 1);
+        solver.set_inprocessing(request.inprocess);
+        solver.set_compact(request.compact);
+
+        // Solve in the background so a stopping server can cancel it
+        SolveHandle handle = solver.solve_async(*formula);
+        while (!handle.wait_for(0.1)) {
+            if (stopping.load(std::memory_order_relaxed)) {
+                handle.cancel();
+            }
+        }
+        switch (handle.wait()) {
+            case SolveStatus::SAT: return format_literals("SAT", solver.get_model());
+            case SolveStatus::UNSAT: return "UNSAT\n";
+            default: return "UNKNOWN\n";
+        }
+    }
+};
+
+SolverServer::SolverServer() : impl_(std::make_unique<Impl>()) {}
+
+SolverServer::~SolverServer() {
+    impl_->close_all();
+}
+
+void SolverServer::set_workers(size_t workers) {
+    impl_->workers = workers;
+}
+
+void SolverServer::set_cache_size(size_t formulas) {
+    impl_->cache_size = formulas;
+}
+
+void SolverServer::set_max_timeout(double seconds) {
+    impl_->max_timeout = seconds;
+}
+
+bool SolverServer::listen(const std::string& socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+        impl_->error_message = "Invalid socket path: " + socket_path;
+        impl_->has_error_flag = true;
+        return false;
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    impl_->listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (impl_->listen_fd < 0) {
+        return impl_->fail("socket");
+    }
+    ::unlink(socket_path.c_str());
+    if (::bind(impl_->listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        return impl_->fail("Could not bind " + socket_path);
+    }
+    if (::listen(impl_->listen_fd, 64) < 0) {
+        return impl_->fail("listen");
+    }
+    if (::pipe(impl_->wake_pipe) < 0) {
+        return impl_->fail("pipe");
+    }
+    impl_->socket_path = socket_path;
+    return true;
+}
+
+void SolverServer::run() {
+    if (impl_->listen_fd < 0) {
+        return;
+    }
+    impl_->cache = std::make_unique<FormulaCache>(impl_->cache_size);
+
+    // One parser and solver per worker, reused for every request it takes
+    ThreadPool pool(impl_->workers);
+    std::vector<Parser> parsers(pool.size());
+    std::vector<StalmarckSolver> solvers(pool.size());
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+
+    auto reply = [](Connection& connection, const std::string& line) {
+        write_all(connection.fd, line, true);
+    };
+
+    auto dispatch = [&](Connection& connection) {
+        connection.busy = true;
+        impl_->requests++;
+        Request request = std::move(connection.pending);
+        pool.submit([this, &parsers, &solvers, &connection, request](size_t worker) {
+            std::string line = impl_->handle(request, solvers[worker], parsers[worker]);
+            write_all(connection.fd, line, true);
+            connection.busy.store(false, std::memory_order_release);
+            impl_->wake();
+        });
+    };
+
+    // Handle buffered lines until one of them starts a solve
+    auto process = [&](Connection& connection) {
+        std::string line;
+        while (!connection.busy && connection.reader.next_line(line)) {
+            if (connection.reading_inline) {
+                if (line == "end") {
+                    connection.reading_inline = false;
+                    dispatch(connection);
+                } else {
+                    connection.pending.text += line;
+                    connection.pending.text += '\n';
+                }
+                continue;
+            }
+
+            std::istringstream in(line);
+            std::string command;
+            if (!(in >> command)) {
+                continue;
+            }
+            if (command == "stats") {
+                reply(connection, impl_->stats_line());
+                continue;
+            }
+            if (command != "solve") {
+                reply(connection, "ERROR unknown command: " + command + "\n");
+                continue;
+            }
+            connection.pending = Request{};
+            std::string error;
+            if (!parse_request(in, connection.pending, error)) {
+                reply(connection, "ERROR " + error + "\n");
+            } else if (connection.pending.is_inline) {
+                connection.reading_inline = true;
+            } else {
+                dispatch(connection);
+            }
+        }
+    };
+
+    std::vector<pollfd> fds;
+    while (!impl_->stopping.load()) {
+        fds.clear();
+        fds.push_back({impl_->listen_fd, POLLIN, 0});
+        fds.push_back({impl_->wake_pipe[0], POLLIN, 0});
+        for (const auto& [fd, connection] : connections) {
+            if (!connection->busy && !connection->closed) {
+                fds.push_back({fd, POLLIN, 0});
+            }
+        }
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if (fds[1].revents != 0) {
+            char drain[64];
+            ssize_t drained = ::read(impl_->wake_pipe[0], drain, sizeof(drain));
+            (void)drained;
+        }
+        if (fds[0].revents & POLLIN) {
+            int fd = ::accept4(impl_->listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                connections.emplace(fd, std::make_unique<Connection>(fd));
+            }
+        }
+        for (size_t i = 2; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            Connection& connection = *connections[fds[i].fd];
+            if (!connection.reader.fill()) {
+                connection.closed = true;
+            }
+        }
+
+        // Serve what is buffered, including lines that arrived while a
+        // request was running, and drop idle connections that hung up
+        for (auto it = connections.begin(); it != connections.end();) {
+            Connection& connection = *it->second;
+            process(connection);
+            if (connection.closed && !connection.busy) {
+                ::close(connection.fd);
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Running requests see the stop flag and cancel their solves
+    pool.wait();
+    for (const auto& [fd, connection] : connections) {
+        ::close(fd);
+    }
+    impl_->close_all();
+    ::unlink(impl_->socket_path.c_str());
+}
+
+void SolverServer::stop() {
+    impl_->stopping.store(true);
+    if (impl_->wake_pipe[1] >= 0) {
+        impl_->wake();
+    }
+}
+
+bool SolverServer::has_error() const {
+    return impl_->has_error_flag;
+}
+
+std::string SolverServer::get_error() const {
+    return impl_->error_message;
+}
+
+} // namespace stalmarck
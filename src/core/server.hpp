@@ -0,0 +1,74 @@
+#pragma once
+
+#include "stalmarck.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace stalmarck {
+
+// 64-bit FNV-1a hash of a byte string
+uint64_t content_hash(const std::string& data);
+
+// Least-recently-used cache of parsed and encoded formulas, keyed by the
+// content hash of their DIMACS text. Safe to use from several threads.
+class FormulaCache {
+public:
+    explicit FormulaCache(size_t capacity = 64);
+    ~FormulaCache();
+
+    // nullptr on a miss; a hit becomes the most recently used entry
+    std::shared_ptr<const Formula> get(uint64_t key);
+
+    // Insert or replace, evicting the least recently used entry when full
+    void put(uint64_t key, std::shared_ptr<const Formula> formula);
+
+    size_t size() const;
+    size_t capacity() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Long-running solver service on a Unix domain socket. Clients send one
+// request per line and get one reply line per request, in order:
+//
+//   solve [timeout <s>] [lookahead <n>] [inprocess] [compact] file <path>
+//   solve [options] inline        DIMACS lines follow, ended by "end"
+//       -> "SAT <lit> ... 0" | "UNSAT" | "UNKNOWN" | "ERROR <message>"
+//   stats
+//       -> "STATS requests <n> hits <n> misses <n> cached <n>"
+//
+// Formulas are kept encoded in a FormulaCache, so repeated instances skip
+// parsing and encoding. Requests run on a fixed pool of workers, each with
+// a solver it reuses; a connection has at most one request in flight.
+class SolverServer {
+public:
+    SolverServer();
+    ~SolverServer();
+
+    // Configuration methods
+    void set_workers(size_t workers);      // 0 = hardware concurrency
+    void set_cache_size(size_t formulas);  // default 64
+    void set_max_timeout(double seconds);  // per-request cap, 0 = none
+
+    // Bind the socket, replacing a stale socket file; false and sets the error on failure
+    bool listen(const std::string& socket_path);
+
+    // Serve until stop(); removes the socket file on return
+    void run();
+
+    // Make run() return; safe to call from a signal handler
+    void stop();
+
+    // Error handling
+    bool has_error() const;
+    std::string get_error() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace stalmarck
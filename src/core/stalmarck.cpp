@@ -1,46 +1,216 @@
 #include "core/stalmarck.hpp"
 #include "solver/solver.hpp"
+#include "solver/local_search.hpp"
 #include "parser/parser.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
 #include <string>
 #include <memory>
+#include <thread>
 
 namespace stalmarck {
 
+struct SolveHandle::State {
+    std::atomic<bool> stop{false};
+    std::promise<SolveStatus> promise;
+    std::shared_future<SolveStatus> result = promise.get_future().share();
+};
+
+bool SolveHandle::valid() const {
+    return state_ != nullptr;
+}
+
+bool SolveHandle::ready() const {
+    return wait_for(0.0);
+}
+
+bool SolveHandle::wait_for(double seconds) const {
+    if (!state_) {
+        return false;
+    }
+    return state_->result.wait_for(std::chrono::duration<double>(seconds)) == std::future_status::ready;
+}
+
+SolveStatus SolveHandle::wait() const {
+    if (!state_) {
+        return SolveStatus::UNKNOWN;
+    }
+    return state_->result.get();
+}
+
+void SolveHandle::cancel() {
+    if (state_) {
+        state_->stop.store(true, std::memory_order_relaxed);
+    }
+}
+
 class StalmarckSolver::Impl {
 public:
     Solver solver;
     Parser parser;
     bool is_tautology_result = false;
+    SolveStatus status = SolveStatus::UNKNOWN;
     double timeout = 0.0;
     int verbosity = 0;
+
+    // Local search pre-phase; off when local_search_seconds is 0
+    double local_search_seconds = 0.0;
+    LocalSearch local_search;
+    bool local_search_answered = false;
+
+    // Background solve started by solve_async, if any
+    std::thread worker;
+    std::shared_ptr<SolveHandle::State> async_state;
+
+    void join_worker() {
+        if (worker.joinable()) {
+            worker.join();
+        }
+        async_state.reset();
+    }
 };
 
 StalmarckSolver::StalmarckSolver() : impl_(std::make_unique<Impl>()) {}
-StalmarckSolver::~StalmarckSolver() = default;
+
+StalmarckSolver::~StalmarckSolver() {
+    if (impl_->async_state) {
+        impl_->async_state->stop.store(true, std::memory_order_relaxed);
+    }
+    impl_->join_worker();
+}
 
 bool StalmarckSolver::solve(const std::string& filename) {
-    Formula parsed = impl_->parser.parse_dimacs(filename);
+    Formula parsed = impl_->parser.parse_file(filename);
     if (impl_->parser.has_error()) {
         return false;
     }
     
-    impl_->is_tautology_result = impl_->solver.solve(parsed);
-    return true;
+    return solve(parsed);
 }
 
 bool StalmarckSolver::solve(const Formula& formula) {
-    impl_->is_tautology_result = impl_->solver.solve(formula);
+    return solve(formula, {});
+}
+
+bool StalmarckSolver::solve(const Formula& formula, const std::vector<int>& assumptions) {
+    double timeout = impl_->timeout;
+    impl_->local_search_answered = false;
+    impl_->solver.set_phase_hints({});
+
+    // Local search first, within the time limit; what it gets closest
+    // to guides the complete search. It knows nothing of assumptions
+    if (impl_->local_search_seconds > 0.0 && assumptions.empty()) {
+        auto start = std::chrono::steady_clock::now();
+        double budget = impl_->local_search_seconds;
+        impl_->local_search.set_timeout(timeout > 0.0 ? std::min(budget, timeout) : budget);
+        if (impl_->local_search.solve(formula)) {
+            impl_->solver.reset();
+            impl_->local_search_answered = true;
+            impl_->is_tautology_result = true;
+            impl_->status = SolveStatus::SAT;
+            return true;
+        }
+        impl_->solver.set_phase_hints(impl_->local_search.get_best_assignment());
+        if (timeout > 0.0) {
+            timeout -= std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (timeout <= 0.0) {
+                impl_->solver.reset();
+                impl_->is_tautology_result = false;
+                impl_->status = SolveStatus::UNKNOWN;
+                return true;
+            }
+        }
+    }
+
+    impl_->solver.set_timeout(timeout);
+    impl_->is_tautology_result = impl_->solver.solve(formula, assumptions);
+
+    if (impl_->solver.is_interrupted()) {
+        impl_->status = SolveStatus::UNKNOWN;
+    } else {
+        impl_->status = impl_->is_tautology_result ? SolveStatus::SAT : SolveStatus::UNSAT;
+    }
     return true;
 }
 
+SolveHandle StalmarckSolver::solve_async(const Formula& formula, const std::vector<int>& assumptions) {
+    impl_->join_worker();
+
+    SolveHandle handle;
+    handle.state_ = std::make_shared<SolveHandle::State>();
+    impl_->async_state = handle.state_;
+    impl_->solver.set_stop_flag(&handle.state_->stop);
+    impl_->local_search.set_stop_flag(&handle.state_->stop);
+    impl_->worker = std::thread([this, &formula, assumptions, state = handle.state_] {
+        // An exception from the solve (say, from a progress callback)
+        // reaches the caller through wait() instead of ending the process
+        std::exception_ptr error;
+        try {
+            solve(formula, assumptions);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        impl_->solver.set_stop_flag(nullptr);
+        impl_->local_search.set_stop_flag(nullptr);
+        if (error) {
+            state->promise.set_exception(error);
+        } else {
+            state->promise.set_value(impl_->status);
+        }
+    });
+    return handle;
+}
+
 bool StalmarckSolver::is_tautology() const {
     return impl_->is_tautology_result;
 }
 
+SolveStatus StalmarckSolver::get_status() const {
+    return impl_->status;
+}
+
+const std::vector<int>& StalmarckSolver::get_model() const {
+    if (impl_->local_search_answered) {
+        return impl_->local_search.get_model();
+    }
+    return impl_->solver.get_model();
+}
+
+const SolverStats& StalmarckSolver::get_stats() const {
+    return impl_->solver.get_stats();
+}
+
 void StalmarckSolver::set_timeout(double seconds) {
     impl_->timeout = seconds;
 }
 
+void StalmarckSolver::set_lookahead(size_t candidates, size_t threads) {
+    impl_->solver.set_lookahead(candidates, threads);
+}
+
+void StalmarckSolver::set_inprocessing(bool enabled, double effort) {
+    impl_->solver.set_inprocessing(enabled, effort);
+}
+
+void StalmarckSolver::set_compact(bool enabled) {
+    impl_->solver.set_compact(enabled);
+}
+
+void StalmarckSolver::set_progress_callback(ProgressCallback callback, double interval) {
+    impl_->solver.set_progress_callback(std::move(callback), interval);
+}
+
+void StalmarckSolver::set_phase_counters(bool enabled) {
+    impl_->solver.set_phase_counters(enabled);
+}
+
+void StalmarckSolver::set_local_search(double seconds) {
+    impl_->local_search_seconds = seconds;
+}
+
 void StalmarckSolver::set_verbosity(int level) {
     impl_->verbosity = level;
 }
@@ -4,9 +4,32 @@
 #include <memory>
 #include <string>
 #include "formula.hpp"
+#include "../solver/solver.hpp"
 
 namespace stalmarck {
 
+// Outcome of the last solve; UNKNOWN when a resource limit was hit
+enum class SolveStatus { SAT, UNSAT, UNKNOWN };
+
+// Future-like handle to a solve running in the background. Copies share the
+// same solve; a default-constructed handle is not valid, never becomes ready,
+// waits as UNKNOWN and ignores cancel().
+class SolveHandle {
+public:
+    bool valid() const;
+    bool ready() const;
+    bool wait_for(double seconds) const; // true once finished
+    SolveStatus wait() const;            // block until finished; rethrows what the solve threw
+
+    // Ask the solve to stop at its next decision; it then ends UNKNOWN
+    void cancel();
+
+private:
+    friend class StalmarckSolver;
+    struct State;
+    std::shared_ptr<State> state_;
+};
+
 class StalmarckSolver {
 public:
     StalmarckSolver();
@@ -15,10 +38,30 @@ public:
     // Main interface methods
     bool solve(const std::string& filename); // Changed from formula to filename
     bool solve(const Formula& formula);
+    bool solve(const Formula& formula, const std::vector<int>& assumptions);
+
+    // Solve on a background thread. The formula must outlive the solve, and
+    // the solver must not be used until the handle is ready; results are
+    // read from the solver as after solve(). Starting another solve waits
+    // for the previous one, and destroying the solver cancels it.
+    SolveHandle solve_async(const Formula& formula, const std::vector<int>& assumptions = {});
     bool is_tautology() const;
+    SolveStatus get_status() const;
+    const std::vector<int>& get_model() const;
+    const SolverStats& get_stats() const;
     
     // Configuration methods
     void set_timeout(double seconds);
+    void set_lookahead(size_t candidates, size_t threads = 1); // see Solver
+    void set_inprocessing(bool enabled, double effort = 0.1);  // see Solver
+    void set_compact(bool enabled);                            // see Solver
+    void set_progress_callback(ProgressCallback callback, double interval = 0.5); // see Solver
+    void set_phase_counters(bool enabled);                     // see Solver
+
+    // Run local search (see LocalSearch) for up to `seconds` before the
+    // complete search, which then splits towards the best assignment it
+    // found; 0 turns it off. Solves under assumptions skip it.
+    void set_local_search(double seconds);
     void set_verbosity(int level);
 
 private:
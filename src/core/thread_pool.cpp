@@ -0,0 +1,83 @@
+#include "core/thread_pool.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace stalmarck {
+
+class ThreadPool::Impl {
+public:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void(size_t)>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    std::condition_variable idle;
+    size_t active = 0;
+    bool stopping = false;
+
+    void run(size_t worker) {
+        while (true) {
+            std::function<void(size_t)> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                task_available.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                active++;
+            }
+
+            task(worker);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            active--;
+            if (active == 0 && tasks.empty()) {
+                idle.notify_all();
+            }
+        }
+    }
+};
+
+ThreadPool::ThreadPool(size_t num_threads) : impl_(std::make_unique<Impl>()) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        impl_->workers.emplace_back([this, i] { impl_->run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->stopping = true;
+    }
+    impl_->task_available.notify_all();
+    for (auto& worker : impl_->workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void(size_t)> task) {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->tasks.push_back(std::move(task));
+    }
+    impl_->task_available.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(impl_->mutex);
+    impl_->idle.wait(lock, [this] { return impl_->active == 0 && impl_->tasks.empty(); });
+}
+
+size_t ThreadPool::size() const {
+    return impl_->workers.size();
+}
+
+} // namespace stalmarck
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace stalmarck {
+
+// Fixed-size worker pool. Tasks receive the index of the worker running
+// them, so callers can keep per-worker state (solvers, scratch buffers).
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_threads = 0); // 0 = hardware concurrency
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Task submission
+    void submit(std::function<void(size_t worker)> task);
+    void wait();
+
+    size_t size() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace stalmarck
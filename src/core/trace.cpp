@@ -0,0 +1,188 @@
+#include "core/trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace stalmarck {
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    int64_t start;    // ticks since start_trace
+    int64_t duration; // ticks
+    int64_t arg;
+};
+
+struct TraceBuffer {
+    std::vector<TraceEvent> events; // ring
+    std::atomic<uint64_t> recorded{0};
+    std::string thread_name;        // guarded by TraceState::mutex
+    size_t id = 0;
+};
+
+struct TraceState {
+    std::atomic<bool> enabled{false};
+    std::atomic<uint64_t> generation{0}; // bumped by each start_trace
+    size_t capacity = size_t{1} << 16;
+    std::chrono::steady_clock::time_point epoch;
+    int64_t epoch_ticks = 0;
+    std::mutex mutex; // guards buffers and thread names
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+};
+
+TraceState trace_state;
+
+// The calling thread's ring, valid while local_generation is current
+thread_local TraceBuffer* local_buffer = nullptr;
+thread_local uint64_t local_generation = 0;
+
+// Spans read the clock twice, so use the cheapest one: the time stamp
+// counter where there is one, scaled to wall time when writing
+int64_t trace_ticks() {
+#if defined(__x86_64__)
+    return static_cast<int64_t>(__rdtsc());
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+TraceBuffer* thread_buffer() {
+    uint64_t generation = trace_state.generation.load(std::memory_order_acquire);
+    if (local_buffer != nullptr && local_generation == generation) {
+        return local_buffer;
+    }
+    std::lock_guard<std::mutex> lock(trace_state.mutex);
+    auto buffer = std::make_unique<TraceBuffer>();
+    buffer->events.resize(trace_state.capacity);
+    buffer->id = trace_state.buffers.size() + 1;
+    local_buffer = buffer.get();
+    local_generation = generation;
+    trace_state.buffers.push_back(std::move(buffer));
+    return local_buffer;
+}
+
+void write_escaped(std::ostream& out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+}
+
+} // namespace
+
+void start_trace(size_t events_per_thread) {
+    std::lock_guard<std::mutex> lock(trace_state.mutex);
+    trace_state.buffers.clear();
+    trace_state.capacity = std::max<size_t>(events_per_thread, 1);
+    trace_state.epoch = std::chrono::steady_clock::now();
+    trace_state.epoch_ticks = trace_ticks();
+    trace_state.generation.fetch_add(1, std::memory_order_release);
+    trace_state.enabled.store(true, std::memory_order_release);
+}
+
+void stop_trace() {
+    trace_state.enabled.store(false, std::memory_order_relaxed);
+}
+
+bool trace_enabled() {
+    return trace_state.enabled.load(std::memory_order_relaxed);
+}
+
+void set_trace_thread_name(const std::string& name) {
+    if (!trace_enabled()) {
+        return;
+    }
+    TraceBuffer* buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(trace_state.mutex);
+    buffer->thread_name = name;
+}
+
+TraceSpan::TraceSpan(const char* name, int64_t arg) : name_(name), arg_(arg) {
+    if (name != nullptr && trace_enabled()) {
+        start_ = trace_ticks() - trace_state.epoch_ticks;
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if (start_ < 0) {
+        return;
+    }
+    int64_t end = trace_ticks() - trace_state.epoch_ticks;
+    TraceBuffer* buffer = thread_buffer();
+    uint64_t n = buffer->recorded.load(std::memory_order_relaxed);
+    buffer->events[n % buffer->events.size()] = TraceEvent{name_, start_, end - start_, arg_};
+    buffer->recorded.store(n + 1, std::memory_order_release);
+}
+
+void write_trace(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(trace_state.mutex);
+
+    // Nanoseconds per tick, measured over the trace so far
+    double elapsed_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - trace_state.epoch).count();
+    int64_t elapsed_ticks = trace_ticks() - trace_state.epoch_ticks;
+    double ns_per_tick = elapsed_ticks > 0 ? elapsed_ns / static_cast<double>(elapsed_ticks) : 0.0;
+    auto to_ns = [ns_per_tick](int64_t ticks) {
+        return std::max(0LL, static_cast<long long>(static_cast<double>(ticks) * ns_per_tick));
+    };
+
+    int pid = static_cast<int>(getpid());
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    const char* separator = "\n";
+    char line[256];
+    for (const auto& buffer : trace_state.buffers) {
+        if (!buffer->thread_name.empty()) {
+            out << separator << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid
+                << ", \"tid\": " << buffer->id << ", \"args\": {\"name\": \"";
+            write_escaped(out, buffer->thread_name);
+            out << "\"}}";
+            separator = ",\n";
+        }
+        // Oldest first; a ring that wrapped has lost everything before.
+        // Times are in microseconds
+        uint64_t recorded = buffer->recorded.load(std::memory_order_acquire);
+        uint64_t size = buffer->events.size();
+        for (uint64_t i = recorded > size ? recorded - size : 0; i < recorded; ++i) {
+            const TraceEvent& event = buffer->events[i % size];
+            long long start = to_ns(event.start);
+            long long duration = to_ns(event.duration);
+            int length = std::snprintf(line, sizeof(line),
+                "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": %zu, "
+                "\"ts\": %lld.%03lld, \"dur\": %lld.%03lld",
+                separator, event.name, pid, buffer->id,
+                start / 1000, start % 1000, duration / 1000, duration % 1000);
+            if (event.arg != 0 && length > 0 && length < static_cast<int>(sizeof(line))) {
+                length += std::snprintf(line + length, sizeof(line) - length,
+                                        ", \"args\": {\"value\": %" PRId64 "}", event.arg);
+            }
+            out.write(line, std::min<int>(length, sizeof(line) - 1));
+            out << '}';
+            separator = ",\n";
+        }
+    }
+    out << "\n]}\n";
+}
+
+bool write_trace_file(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return false;
+    }
+    write_trace(out);
+    return static_cast<bool>(out);
+}
+
+} // namespace stalmarck
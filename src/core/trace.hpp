@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace stalmarck {
+
+// Timeline of solver phases as Chrome trace-event JSON, for chrome://tracing
+// or ui.perfetto.dev.
+//
+// Tracing is off until start_trace(); until then a span costs a call and
+// one relaxed load. Each thread records into its own fixed-size ring,
+// written by that thread alone, so recording takes no lock. A full ring
+// overwrites its oldest events, so a long run keeps its recent history.
+
+// Start recording, keeping up to events_per_thread events per thread.
+// Restarting clears what was recorded, so no traced thread may be running
+void start_trace(size_t events_per_thread = size_t{1} << 16);
+void stop_trace();
+bool trace_enabled();
+
+// Label the calling thread in the output, e.g. "portfolio 2"
+void set_trace_thread_name(const std::string& name);
+
+// Write every thread's events. Threads that are still recording may race
+// with this, so call it once they have finished
+void write_trace(std::ostream& out);
+bool write_trace_file(const std::string& path);
+
+// Records its lifetime as one event. The name must outlive the trace (a
+// string literal), and a null name records nothing, for spans only wanted
+// some of the time. A nonzero arg is shown with the event, e.g. the
+// literal a split decides
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, int64_t arg = 0);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    int64_t arg_;
+    int64_t start_ = -1; // -1 when not recording
+};
+
+} // namespace stalmarck
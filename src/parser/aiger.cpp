@@ -0,0 +1,359 @@
+#include "parser/aiger.hpp"
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stalmarck {
+
+namespace {
+
+// AIGER literals are 2 * variable + sign; 0 and 1 are the constants
+constexpr uint32_t FALSE_LITERAL = 0;
+constexpr uint32_t TRUE_LITERAL = 1;
+
+enum class Node : uint8_t { Undefined, Leaf, Gate };
+
+class AigerReader {
+public:
+    AigerReader(std::istream& input, std::string& error) : input_(input), error_(error) {}
+
+    bool read(Formula& formula) {
+        return read_header() && read_body() && build(formula);
+    }
+
+private:
+    bool fail(const std::string& message) {
+        error_ = message;
+        return false;
+    }
+
+    bool read_header() {
+        std::string line;
+        if (!std::getline(input_, line)) {
+            return fail("Empty AIGER file");
+        }
+        std::istringstream fields(line);
+        std::string format;
+        fields >> format;
+        if (format != "aag" && format != "aig") {
+            return fail("Invalid AIGER header");
+        }
+        binary_ = format == "aig";
+
+        // M I L O A, then the optional B C J F of format 1.9
+        uint64_t counts[9] = {0};
+        size_t n = 0;
+        while (n < 9 && fields >> counts[n]) {
+            n++;
+        }
+        if (n < 5 || !(fields >> std::ws).eof()) {
+            return fail("Invalid AIGER header");
+        }
+        max_var_ = counts[0];
+        num_inputs_ = counts[1];
+        num_latches_ = counts[2];
+        num_outputs_ = counts[3];
+        num_ands_ = counts[4];
+        num_bad_ = counts[5];
+        num_constraints_ = counts[6];
+        if (counts[7] != 0 || counts[8] != 0) {
+            return fail("AIGER justice and fairness properties are not supported");
+        }
+        if (max_var_ > static_cast<uint64_t>(std::numeric_limits<int32_t>::max() / 2) ||
+            num_inputs_ + num_latches_ + num_ands_ > max_var_) {
+            return fail("Invalid AIGER header");
+        }
+        if (binary_ && num_inputs_ + num_latches_ + num_ands_ != max_var_) {
+            return fail("Binary AIGER header must have M = I + L + A");
+        }
+        if (num_outputs_ + num_bad_ == 0) {
+            return fail("AIGER file has no outputs");
+        }
+        node_.assign(max_var_ + 1, Node::Undefined);
+        rhs0_.assign(max_var_ + 1, 0);
+        rhs1_.assign(max_var_ + 1, 0);
+        return true;
+    }
+
+    // One line of up to `count` literals; optional trailing fields are
+    // left at zero
+    bool read_line(uint32_t* values, size_t required, size_t count) {
+        std::string line;
+        if (!std::getline(input_, line)) {
+            return fail("Unexpected end of AIGER file");
+        }
+        std::istringstream fields(line);
+        size_t n = 0;
+        uint64_t value;
+        while (n < count && fields >> value) {
+            if (value > 2 * max_var_ + 1) {
+                return fail("AIGER literal exceeds declared maximum: " + std::to_string(value));
+            }
+            values[n++] = static_cast<uint32_t>(value);
+        }
+        if (n < required) {
+            return fail("Malformed AIGER line: " + line);
+        }
+        for (size_t i = n; i < count; ++i) {
+            values[i] = 0;
+        }
+        return true;
+    }
+
+    bool define(uint32_t lit, Node kind) {
+        uint32_t var = lit >> 1;
+        if ((lit & 1) != 0 || var == 0) {
+            return fail("AIGER definition of a negated or constant literal");
+        }
+        if (node_[var] != Node::Undefined) {
+            return fail("AIGER variable defined twice: " + std::to_string(var));
+        }
+        node_[var] = kind;
+        if (kind == Node::Leaf) {
+            leaves_.push_back(var);
+        }
+        return true;
+    }
+
+    bool read_body() {
+        uint32_t values[3];
+        for (uint64_t i = 0; i < num_inputs_; ++i) {
+            if (binary_) {
+                values[0] = static_cast<uint32_t>(2 * (i + 1));
+            } else if (!read_line(values, 1, 1)) {
+                return false;
+            }
+            if (!define(values[0], Node::Leaf)) {
+                return false;
+            }
+        }
+        // Latches are free: their next-state functions and resets play no part
+        for (uint64_t i = 0; i < num_latches_; ++i) {
+            if (binary_) {
+                if (!read_line(values, 1, 2)) {
+                    return false;
+                }
+                values[0] = static_cast<uint32_t>(2 * (num_inputs_ + i + 1));
+            } else if (!read_line(values, 2, 3)) {
+                return false;
+            }
+            if (!define(values[0], Node::Leaf)) {
+                return false;
+            }
+        }
+        for (uint64_t i = 0; i < num_outputs_ + num_bad_; ++i) {
+            if (!read_line(values, 1, 1)) {
+                return false;
+            }
+            targets_.push_back(values[0]);
+        }
+        for (uint64_t i = 0; i < num_constraints_; ++i) {
+            if (!read_line(values, 1, 1)) {
+                return false;
+            }
+            constraints_.push_back(values[0]);
+        }
+        for (uint64_t i = 0; i < num_ands_; ++i) {
+            if (binary_) {
+                if (!read_binary_and(static_cast<uint32_t>(2 * (num_inputs_ + num_latches_ + i + 1)), values)) {
+                    return false;
+                }
+            } else if (!read_line(values, 3, 3)) {
+                return false;
+            }
+            if (!define(values[0], Node::Gate)) {
+                return false;
+            }
+            rhs0_[values[0] >> 1] = values[1];
+            rhs1_[values[0] >> 1] = values[2];
+        }
+        return true;
+    }
+
+    // Binary gates store lhs - rhs0 and rhs0 - rhs1 as 7-bit varints
+    bool read_binary_and(uint32_t lhs, uint32_t* values) {
+        uint64_t delta[2];
+        for (uint64_t& d : delta) {
+            d = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                int byte = input_.get();
+                if (byte == std::char_traits<char>::eof()) {
+                    return fail("Unexpected end of AIGER file");
+                }
+                if (shift > 28) {
+                    return fail("Invalid AIGER gate encoding");
+                }
+                d |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    break;
+                }
+            }
+        }
+        if (delta[0] == 0 || delta[0] > lhs || delta[1] > lhs - delta[0]) {
+            return fail("Invalid AIGER gate encoding");
+        }
+        values[0] = lhs;
+        values[1] = static_cast<uint32_t>(lhs - delta[0]);
+        values[2] = static_cast<uint32_t>(values[1] - delta[1]);
+        return true;
+    }
+
+    // Gates the targets and constraints depend on, children first
+    bool collect_cone(std::vector<uint32_t>& gates) {
+        enum : uint8_t { Unvisited, Open, Done };
+        std::vector<uint8_t> mark(max_var_ + 1, Unvisited);
+        std::vector<uint32_t> stack;
+        auto visit_roots = [&](const std::vector<uint32_t>& roots) {
+            for (uint32_t lit : roots) {
+                stack.push_back(lit >> 1);
+            }
+        };
+        visit_roots(targets_);
+        visit_roots(constraints_);
+
+        while (!stack.empty()) {
+            uint32_t var = stack.back();
+            if (var == 0 || mark[var] == Done) {
+                stack.pop_back();
+                continue;
+            }
+            if (node_[var] == Node::Undefined) {
+                return fail("AIGER literal used but never defined: " + std::to_string(2 * var));
+            }
+            if (node_[var] == Node::Leaf) {
+                mark[var] = Done;
+                stack.pop_back();
+                continue;
+            }
+            if (mark[var] == Open) {
+                mark[var] = Done;
+                gates.push_back(var);
+                stack.pop_back();
+                continue;
+            }
+            mark[var] = Open;
+            for (uint32_t child : {rhs0_[var] >> 1, rhs1_[var] >> 1}) {
+                if (mark[child] == Open) {
+                    return fail("AIGER gates form a cycle");
+                }
+                if (mark[child] == Unvisited) {
+                    stack.push_back(child);
+                }
+            }
+        }
+        return true;
+    }
+
+    static int solver_literal(uint32_t lit) {
+        int var = static_cast<int>(lit >> 1);
+        return (lit & 1) != 0 ? -var : var;
+    }
+
+    // AND of two literals of the rebuilt graph, folding constants and
+    // reusing an existing gate over the same inputs
+    uint32_t make_and(uint32_t b, uint32_t c) {
+        if (b > c) {
+            std::swap(b, c);
+        }
+        if (b == FALSE_LITERAL || b == (c ^ 1)) {
+            return FALSE_LITERAL;
+        }
+        if (b == TRUE_LITERAL || b == c) {
+            return c;
+        }
+        uint64_t key = (static_cast<uint64_t>(b) << 32) | c;
+        auto [it, inserted] = gates_.emplace(key, 0);
+        if (inserted) {
+            uint32_t a = 2 * ++num_vars_;
+            it->second = a;
+            // a <-> (b & c) as -a <-> (b -> -c)
+            triplets_.emplace_back(-solver_literal(a), solver_literal(b), -solver_literal(c));
+        }
+        return it->second;
+    }
+
+    bool build(Formula& formula) {
+        std::vector<uint32_t> gates;
+        if (!collect_cone(gates)) {
+            return false;
+        }
+
+        // Renumber: every input and latch first, in file order, so input i
+        // is variable i and models map back to the circuit; then the gates
+        std::vector<uint32_t> image(max_var_ + 1, FALSE_LITERAL);
+        for (uint32_t var : leaves_) {
+            image[var] = 2 * ++num_vars_;
+        }
+        auto map = [&image](uint32_t lit) { return image[lit >> 1] ^ (lit & 1); };
+        gates_.reserve(gates.size());
+        triplets_.reserve(gates.size() + constraints_.size() + 1);
+        for (uint32_t var : gates) {
+            image[var] = make_and(map(rhs0_[var]), map(rhs1_[var]));
+        }
+
+        // Some target is 1 and every constraint holds
+        uint32_t any_target = FALSE_LITERAL;
+        for (uint32_t lit : targets_) {
+            any_target = make_and(any_target ^ 1, map(lit) ^ 1) ^ 1;
+        }
+        std::vector<uint32_t> asserted = {any_target};
+        for (uint32_t lit : constraints_) {
+            asserted.push_back(map(lit));
+        }
+
+        // (l, l, l) forces l true; a constant-false assertion refutes the
+        // formula through a variable forced both ways
+        bool refuted = false;
+        for (uint32_t lit : asserted) {
+            if (lit == FALSE_LITERAL) {
+                refuted = true;
+            } else if (lit != TRUE_LITERAL) {
+                int l = solver_literal(lit);
+                triplets_.emplace_back(l, l, l);
+            }
+        }
+        if (refuted) {
+            int t = static_cast<int>(++num_vars_);
+            triplets_.emplace_back(t, t, t);
+            triplets_.emplace_back(-t, -t, -t);
+        }
+
+        formula.set_triplets(std::move(triplets_), num_vars_);
+        return true;
+    }
+
+    std::istream& input_;
+    std::string& error_;
+    bool binary_ = false;
+    uint64_t max_var_ = 0;
+    uint64_t num_inputs_ = 0;
+    uint64_t num_latches_ = 0;
+    uint64_t num_outputs_ = 0;
+    uint64_t num_ands_ = 0;
+    uint64_t num_bad_ = 0;
+    uint64_t num_constraints_ = 0;
+
+    std::vector<Node> node_;
+    std::vector<uint32_t> rhs0_;
+    std::vector<uint32_t> rhs1_;
+    std::vector<uint32_t> leaves_;      // inputs and latches in file order
+    std::vector<uint32_t> targets_;     // outputs and bad-state properties
+    std::vector<uint32_t> constraints_; // invariant constraints
+
+    uint32_t num_vars_ = 0;
+    std::unordered_map<uint64_t, uint32_t> gates_; // structural hash: (b, c) -> a
+    std::vector<std::tuple<int, int, int>> triplets_;
+};
+
+} // namespace
+
+bool read_aiger(std::istream& input, Formula& formula, std::string& error) {
+    AigerReader reader(input, error);
+    return reader.read(formula);
+}
+
+} // namespace stalmarck
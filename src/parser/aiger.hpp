@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../core/formula.hpp"
+#include <istream>
+#include <string>
+
+namespace stalmarck {
+
+// AIGER front-end ("aag" ASCII and "aig" binary, up to format 1.9).
+//
+// The formula asks whether some output (or bad-state property) can be 1
+// while every invariant constraint holds; latches are free variables, so
+// sequential circuits are checked for one step from any state. Each AND
+// gate a = b & c becomes the single triplet (-a, b, -c), i.e.
+// -a <-> (b -> -c), with no CNF in between. On the way, gates outside the
+// cone of the outputs are dropped, constants are folded and structurally
+// identical gates share one variable.
+//
+// Variables are renumbered: every input and latch comes first, in file
+// order, so input i (1-based) is variable i and latch j is variable I + j;
+// then the gates.
+//
+// Returns false and sets error on malformed input.
+bool read_aiger(std::istream& input, Formula& formula, std::string& error);
+
+} // namespace stalmarck
@@ -0,0 +1,255 @@
+#include "parser/dimacs.hpp"
+#include "core/trace.hpp"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace stalmarck {
+
+namespace {
+
+// Reads of this size are cut back to the last newline
+constexpr size_t BLOCK_SIZE = size_t{1} << 20;
+constexpr size_t QUEUE_CAPACITY = 4;
+
+// Like `in >> value` for an int: skips whitespace, then takes an optional
+// sign and the digits after it. False, as for a failed extraction, when
+// there is no number or it does not fit in an int
+bool read_int(const char*& pos, const char* end, int& value) {
+    while (pos != end && std::isspace(static_cast<unsigned char>(*pos))) {
+        ++pos;
+    }
+    bool negative = false;
+    if (pos != end && (*pos == '+' || *pos == '-')) {
+        negative = *pos == '-';
+        ++pos;
+    }
+    if (pos == end || !std::isdigit(static_cast<unsigned char>(*pos))) {
+        return false;
+    }
+    long long magnitude = 0;
+    while (pos != end && std::isdigit(static_cast<unsigned char>(*pos))) {
+        // Saturate: anything past the int range fails the same way
+        magnitude = std::min(magnitude * 10 + (*pos - '0'), static_cast<long long>(INT_MAX) + 2);
+        ++pos;
+    }
+    if (negative ? -magnitude < INT_MIN : magnitude > INT_MAX) {
+        return false;
+    }
+    value = static_cast<int>(negative ? -magnitude : magnitude);
+    return true;
+}
+
+// Hand-over between pipeline stages. Either side may close it: producers
+// then stop, and consumers stop once it is drained
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+    // False if the queue was closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // False once the queue is closed and empty
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+};
+
+struct ParsedBlock {
+    std::vector<int> clauses; // each followed by a 0
+    std::vector<std::vector<int>> xors;
+    std::string error;        // set at the first malformed line
+};
+
+} // namespace
+
+DimacsLineParser::Line DimacsLineParser::parse(const char* begin, const char* end,
+                                               std::vector<int>& literals) {
+    literals.clear();
+    if (begin == end || *begin == 'c') {
+        return Line::Skip;
+    }
+
+    if (*begin == 'p') {
+        std::istringstream iss(std::string(begin, end));
+        std::string p, cnf;
+        iss >> p >> cnf >> num_vars_;
+        if (p != "p" || cnf != "cnf") {
+            error_ = "Invalid problem line format";
+            return Line::Error;
+        }
+        return Line::Skip;
+    }
+
+    // "x1 -2 3 0" says 1 ^ -2 ^ 3
+    bool is_xor = *begin == 'x';
+    const char* pos = is_xor ? begin + 1 : begin;
+    int lit;
+    while (read_int(pos, end, lit) && lit != 0) {
+        if (std::abs(lit) > num_vars_) {
+            error_ = "Variable number exceeds declared maximum";
+            return Line::Error;
+        }
+        literals.push_back(lit);
+    }
+    if (is_xor) {
+        return Line::Xor;
+    }
+    return literals.empty() ? Line::Skip : Line::Clause;
+}
+
+bool read_dimacs_pipelined(std::istream& input, Formula& formula, std::string& error) {
+    BoundedQueue<std::string> blocks(QUEUE_CAPACITY);
+    BoundedQueue<ParsedBlock> parsed_blocks(QUEUE_CAPACITY);
+
+    // Read blocks of whole lines; a line longer than a block grows it
+    std::thread reader([&] {
+        set_trace_thread_name("dimacs reader");
+        std::string carry;
+        for (;;) {
+            TraceSpan span("read block");
+            std::string block = std::move(carry);
+            carry.clear();
+            size_t kept = block.size();
+            block.resize(kept + BLOCK_SIZE);
+            input.read(&block[kept], BLOCK_SIZE);
+            size_t got = static_cast<size_t>(input.gcount());
+            block.resize(kept + got);
+            if (got == 0) {
+                // The last line may lack its newline
+                if (!block.empty()) {
+                    blocks.push(std::move(block));
+                }
+                break;
+            }
+            size_t cut = block.rfind('\n');
+            if (cut == std::string::npos) {
+                carry = std::move(block);
+                continue;
+            }
+            carry.assign(block, cut + 1, std::string::npos);
+            block.resize(cut + 1);
+            if (!blocks.push(std::move(block))) {
+                break;
+            }
+        }
+        blocks.close();
+    });
+
+    // Parse each block into flat clauses
+    std::thread parser([&] {
+        set_trace_thread_name("dimacs parser");
+        DimacsLineParser lines;
+        std::vector<int> literals;
+        std::string block;
+        while (blocks.pop(block)) {
+            TraceSpan span("parse block");
+            ParsedBlock parsed;
+            const char* pos = block.data();
+            const char* end = pos + block.size();
+            while (pos != end && parsed.error.empty()) {
+                const char* eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+                if (eol == nullptr) {
+                    eol = end;
+                }
+                switch (lines.parse(pos, eol, literals)) {
+                    case DimacsLineParser::Line::Clause:
+                        parsed.clauses.insert(parsed.clauses.end(), literals.begin(), literals.end());
+                        parsed.clauses.push_back(0);
+                        break;
+                    case DimacsLineParser::Line::Xor:
+                        parsed.xors.push_back(literals);
+                        break;
+                    case DimacsLineParser::Line::Error:
+                        parsed.error = lines.error();
+                        break;
+                    case DimacsLineParser::Line::Skip:
+                        break;
+                }
+                pos = eol == end ? end : eol + 1;
+            }
+            bool failed = !parsed.error.empty();
+            if (!parsed_blocks.push(std::move(parsed)) || failed) {
+                break;
+            }
+        }
+        // Stop the reader too if parsing ended early
+        blocks.close();
+        parsed_blocks.close();
+    });
+
+    // Build the formula, encoding each block while the next is parsed
+    ParsedBlock parsed;
+    std::vector<int> clause;
+    bool failed = false;
+    while (parsed_blocks.pop(parsed)) {
+        if (!parsed.error.empty()) {
+            error = parsed.error;
+            failed = true;
+            break;
+        }
+        auto it = parsed.clauses.begin();
+        while (it != parsed.clauses.end()) {
+            auto zero = std::find(it, parsed.clauses.end(), 0);
+            clause.assign(it, zero);
+            formula.add_clause(clause);
+            it = zero + 1;
+        }
+        for (const auto& literals : parsed.xors) {
+            formula.add_xor(literals);
+        }
+        formula.encode_new_clauses();
+    }
+    parsed_blocks.close();
+    blocks.close();
+    parser.join();
+    reader.join();
+
+    if (failed) {
+        formula = Formula{};
+        return false;
+    }
+    return true;
+}
+
+} // namespace stalmarck
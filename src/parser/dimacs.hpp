@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../core/formula.hpp"
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace stalmarck {
+
+// DIMACS, one line at a time. Empty lines and lines starting with `c` are
+// skipped, `p cnf <vars> <clauses>` sets the bound on variable numbers, and
+// `x` lines are XOR constraints. Any other line is a clause, read up to its
+// first 0 or the first token that is not a number; the rest of the line is
+// ignored.
+class DimacsLineParser {
+public:
+    enum class Line { Skip, Clause, Xor, Error };
+
+    // Clause and Xor leave the literals in `literals`; Error sets error()
+    Line parse(const char* begin, const char* end, std::vector<int>& literals);
+
+    const std::string& error() const { return error_; }
+
+private:
+    int num_vars_ = 0;
+    std::string error_;
+};
+
+// Pipelined loading for large files. A reader thread cuts the input into
+// blocks of whole lines, a parser thread turns each block into clauses,
+// and the calling thread adds them to the formula and stages their triplet
+// encoding (Formula::encode_new_clauses) while the next blocks are read.
+// Stages hand over through bounded queues, so only a few blocks are in
+// flight. The formula, and any error, is the same as Parser::parse_dimacs
+// gives.
+//
+// Returns false and sets error on malformed input.
+bool read_dimacs_pipelined(std::istream& input, Formula& formula, std::string& error);
+
+} // namespace stalmarck
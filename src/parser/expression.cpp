@@ -0,0 +1,339 @@
+#include "parser/expression.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace stalmarck {
+
+namespace {
+
+// Edges are 2 * node + sign, as in AIGER; node 0 is the constant false
+constexpr uint32_t FALSE_EDGE = 0;
+constexpr uint32_t TRUE_EDGE = 1;
+constexpr uint32_t ATOM = UINT32_MAX;
+
+// Parentheses nest by recursion, so their depth is bounded
+constexpr size_t MAX_NESTING = 1000;
+
+enum class Token { End, Ident, True, False, Let, Equals, Semicolon, LParen, RParen, Not, And, Or, Implies, Iff };
+
+class ExpressionReader {
+public:
+    ExpressionReader(std::string text, std::string& error) : text_(std::move(text)), error_(error) {
+        nodes_.push_back({ATOM, ATOM}); // the constant
+    }
+
+    bool read(bool negate, Formula& formula, std::vector<std::string>& atoms) {
+        next();
+        while (!failed_ && token_ == Token::Let) {
+            next();
+            if (token_ != Token::Ident) {
+                return fail("Expected a name after let");
+            }
+            std::string name = ident_;
+            next();
+            if (!expect(Token::Equals, "=")) {
+                return false;
+            }
+            uint32_t value = parse_iff();
+            if (failed_ || !expect(Token::Semicolon, ";")) {
+                return false;
+            }
+            if (!names_.emplace(name, value).second) {
+                return fail("Name already in use: " + name);
+            }
+        }
+        uint32_t root = parse_iff();
+        if (!failed_ && token_ == Token::Semicolon) {
+            next();
+        }
+        if (!failed_ && token_ != Token::End) {
+            return fail("Unexpected input after the formula");
+        }
+        if (failed_) {
+            return false;
+        }
+        encode(negate ? root ^ 1 : root, formula, atoms);
+        return true;
+    }
+
+private:
+    struct Node {
+        uint32_t a; // antecedent edge, or ATOM
+        uint32_t b; // consequent edge, or the atom's name index
+    };
+
+    bool fail(const std::string& message) {
+        if (!failed_) {
+            error_ = message + " on line " + std::to_string(line_);
+            failed_ = true;
+        }
+        return false;
+    }
+
+    bool expect(Token token, const char* text) {
+        if (token_ != token) {
+            return fail(std::string("Expected ") + text);
+        }
+        next();
+        return true;
+    }
+
+    bool match(const char* op) {
+        size_t n = std::char_traits<char>::length(op);
+        if (text_.compare(pos_, n, op) == 0) {
+            pos_ += n;
+            return true;
+        }
+        return false;
+    }
+
+    void next() {
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c == '\n') {
+                line_++;
+                pos_++;
+            } else if (std::isspace(static_cast<unsigned char>(c))) {
+                pos_++;
+            } else if (c == '#') {
+                while (pos_ < text_.size() && text_[pos_] != '\n') {
+                    pos_++;
+                }
+            } else {
+                break;
+            }
+        }
+        if (pos_ == text_.size()) {
+            token_ = Token::End;
+            return;
+        }
+
+        // Longest operators first
+        static const std::pair<const char*, Token> operators[] = {
+            {"<->", Token::Iff}, {"<=>", Token::Iff}, {"↔", Token::Iff},
+            {"->", Token::Implies}, {"=>", Token::Implies}, {"→", Token::Implies},
+            {"||", Token::Or}, {"\\/", Token::Or}, {"|", Token::Or}, {"∨", Token::Or},
+            {"&&", Token::And}, {"/\\", Token::And}, {"&", Token::And}, {"∧", Token::And},
+            {"!", Token::Not}, {"~", Token::Not}, {"¬", Token::Not},
+            {"(", Token::LParen}, {")", Token::RParen}, {";", Token::Semicolon}, {"=", Token::Equals},
+        };
+        for (const auto& [op, token] : operators) {
+            if (match(op)) {
+                token_ = token;
+                return;
+            }
+        }
+
+        char c = text_[pos_];
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = pos_;
+            while (pos_ < text_.size() && (std::isalnum(static_cast<unsigned char>(text_[pos_])) ||
+                                           text_[pos_] == '_' || text_[pos_] == '.' || text_[pos_] == '\'')) {
+                pos_++;
+            }
+            ident_ = text_.substr(start, pos_ - start);
+            token_ = ident_ == "let" ? Token::Let
+                   : ident_ == "true" ? Token::True
+                   : ident_ == "false" ? Token::False
+                   : Token::Ident;
+            return;
+        }
+        fail(std::string("Unexpected character '") + c + "'");
+        token_ = Token::End;
+    }
+
+    // a <-> b <-> c, left to right
+    uint32_t parse_iff() {
+        uint32_t left = parse_implies();
+        while (!failed_ && token_ == Token::Iff) {
+            next();
+            uint32_t right = parse_implies();
+            left = make_and(make_implies(left, right), make_implies(right, left));
+        }
+        return left;
+    }
+
+    // a -> b -> c is a -> (b -> c)
+    uint32_t parse_implies() {
+        std::vector<uint32_t> operands = {parse_or()};
+        while (!failed_ && token_ == Token::Implies) {
+            next();
+            operands.push_back(parse_or());
+        }
+        uint32_t result = operands.back();
+        for (size_t i = operands.size() - 1; i-- > 0;) {
+            result = make_implies(operands[i], result);
+        }
+        return result;
+    }
+
+    uint32_t parse_or() {
+        uint32_t left = parse_and();
+        while (!failed_ && token_ == Token::Or) {
+            next();
+            left = make_implies(left ^ 1, parse_and());
+        }
+        return left;
+    }
+
+    uint32_t parse_and() {
+        uint32_t left = parse_unary();
+        while (!failed_ && token_ == Token::And) {
+            next();
+            left = make_and(left, parse_unary());
+        }
+        return left;
+    }
+
+    uint32_t parse_unary() {
+        uint32_t sign = 0;
+        while (token_ == Token::Not) {
+            sign ^= 1;
+            next();
+        }
+        switch (token_) {
+            case Token::True:
+                next();
+                return TRUE_EDGE ^ sign;
+            case Token::False:
+                next();
+                return FALSE_EDGE ^ sign;
+            case Token::Ident: {
+                auto [it, inserted] = names_.emplace(ident_, 0);
+                if (inserted) {
+                    it->second = 2 * static_cast<uint32_t>(nodes_.size());
+                    nodes_.push_back({ATOM, static_cast<uint32_t>(atom_names_.size())});
+                    atom_names_.push_back(ident_);
+                }
+                next();
+                return it->second ^ sign;
+            }
+            case Token::LParen: {
+                if (++depth_ > MAX_NESTING) {
+                    fail("Formula nested too deeply");
+                    return FALSE_EDGE;
+                }
+                next();
+                uint32_t inner = parse_iff();
+                depth_--;
+                if (!failed_) {
+                    expect(Token::RParen, ")");
+                }
+                return inner ^ sign;
+            }
+            default:
+                fail("Expected a formula");
+                return FALSE_EDGE;
+        }
+    }
+
+    uint32_t make_and(uint32_t a, uint32_t b) {
+        return make_implies(a, b ^ 1) ^ 1;
+    }
+
+    // a -> b with constants folded; a formula and its contrapositive
+    // share one node
+    uint32_t make_implies(uint32_t a, uint32_t b) {
+        if (a == FALSE_EDGE || b == TRUE_EDGE || a == b) {
+            return TRUE_EDGE;
+        }
+        if (a == TRUE_EDGE) {
+            return b;
+        }
+        if (b == FALSE_EDGE || a == (b ^ 1)) {
+            return a ^ 1;
+        }
+        if (std::make_pair(b ^ 1, a ^ 1) < std::make_pair(a, b)) {
+            std::tie(a, b) = std::make_pair(b ^ 1, a ^ 1);
+        }
+        uint64_t key = (static_cast<uint64_t>(a) << 32) | b;
+        auto [it, inserted] = implications_.emplace(key, 0);
+        if (inserted) {
+            it->second = 2 * static_cast<uint32_t>(nodes_.size());
+            nodes_.push_back({a, b});
+        }
+        return it->second;
+    }
+
+    void encode(uint32_t root, Formula& formula, std::vector<std::string>& atoms) {
+        // Nodes the root depends on; children always precede their parents
+        std::vector<uint8_t> reached(nodes_.size(), 0);
+        std::vector<uint32_t> stack = {root >> 1};
+        while (!stack.empty()) {
+            uint32_t node = stack.back();
+            stack.pop_back();
+            if (node == 0 || reached[node]) {
+                continue;
+            }
+            reached[node] = 1;
+            if (nodes_[node].a != ATOM) {
+                stack.push_back(nodes_[node].a >> 1);
+                stack.push_back(nodes_[node].b >> 1);
+            }
+        }
+
+        // Atoms first, then the implications
+        std::vector<int> variable(nodes_.size(), 0);
+        int num_vars = 0;
+        atoms.clear();
+        for (size_t node = 1; node < nodes_.size(); ++node) {
+            if (reached[node] && nodes_[node].a == ATOM) {
+                variable[node] = ++num_vars;
+                atoms.push_back(atom_names_[nodes_[node].b]);
+            }
+        }
+        auto literal = [&variable](uint32_t edge) {
+            int var = variable[edge >> 1];
+            return (edge & 1) != 0 ? -var : var;
+        };
+        std::vector<std::tuple<int, int, int>> triplets;
+        for (size_t node = 1; node < nodes_.size(); ++node) {
+            if (reached[node] && nodes_[node].a != ATOM) {
+                variable[node] = ++num_vars;
+                triplets.emplace_back(num_vars, literal(nodes_[node].a), literal(nodes_[node].b));
+            }
+        }
+
+        // (l, l, l) asserts l; a constant-false root refutes the formula
+        // through a variable forced both ways
+        if (root == FALSE_EDGE) {
+            int t = ++num_vars;
+            triplets.emplace_back(t, t, t);
+            triplets.emplace_back(-t, -t, -t);
+        } else if (root != TRUE_EDGE) {
+            int l = literal(root);
+            triplets.emplace_back(l, l, l);
+        }
+        formula.set_triplets(std::move(triplets), static_cast<size_t>(num_vars));
+    }
+
+    std::string text_;
+    std::string& error_;
+    size_t pos_ = 0;
+    size_t line_ = 1;
+    size_t depth_ = 0;
+    bool failed_ = false;
+    Token token_ = Token::End;
+    std::string ident_;
+
+    std::vector<Node> nodes_;
+    std::vector<std::string> atom_names_;
+    std::unordered_map<std::string, uint32_t> names_;      // atoms and let bindings
+    std::unordered_map<uint64_t, uint32_t> implications_;  // hash-consing: (a, b) -> node edge
+};
+
+} // namespace
+
+bool read_expression(std::istream& input, bool negate, Formula& formula,
+                     std::vector<std::string>& atoms, std::string& error) {
+    std::string text(std::istreambuf_iterator<char>(input), {});
+    ExpressionReader reader(std::move(text), error);
+    return reader.read(negate, formula, atoms);
+}
+
+} // namespace stalmarck
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../core/formula.hpp"
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace stalmarck {
+
+// Propositional formulas in infix syntax, from loosest to tightest binding:
+//
+//   a <-> b   also <=>, ↔     left-associative
+//   a -> b    also =>, →      right-associative
+//   a | b     also ||, \/, ∨
+//   a & b     also &&, /\, ∧
+//   !a        also ~, ¬
+//
+// with parentheses, the constants true and false, and identifiers as atoms.
+// Any number of `let name = formula;` bindings may precede the formula
+// itself, for sharing; # starts a comment to the end of the line.
+//
+// The formula becomes a hash-consed DAG of implications (x <-> (y -> z),
+// the triplet form itself), so each distinct subformula is one triplet and
+// no CNF is built. The root is asserted true, or false with negate: then
+// the result is UNSAT exactly when the input is a tautology.
+//
+// Atoms the formula depends on are variables 1..n in order of first use,
+// named by `atoms`; subformulas follow. Returns false and sets error on
+// malformed input.
+bool read_expression(std::istream& input, bool negate, Formula& formula,
+                     std::vector<std::string>& atoms, std::string& error);
+
+} // namespace stalmarck
@@ -1,6 +1,10 @@
 #include "parser/parser.hpp"
 #include "core/formula.hpp"
 #include "core/formula_impl.hpp"
+#include "core/trace.hpp"
+#include "parser/aiger.hpp"
+#include "parser/dimacs.hpp"
+#include "parser/expression.hpp"
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -11,65 +15,142 @@ class Parser::Impl {
 public:
     std::string error_message;
     bool has_error_flag = false;
+    bool pipelined = false;
+    std::vector<std::string> atom_names;
+
+    Formula parse(std::istream& input);
+    Formula parse_expression(std::istream& input, bool negate);
 };
 
 Parser::Parser() : impl_(std::make_unique<Impl>()) {}
 Parser::~Parser() = default;
 
 Formula Parser::parse_dimacs(const std::string& filename) {
+    // Parsers are reused across files, so drop any earlier error
+    impl_->error_message.clear();
+    impl_->has_error_flag = false;
+
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        impl_->error_message = "Could not open file: " + filename;
+        impl_->has_error_flag = true;
+        return Formula{};
+    }
+    if (impl_->pipelined) {
+        Formula formula;
+        if (!read_dimacs_pipelined(file, formula, impl_->error_message)) {
+            impl_->has_error_flag = true;
+            return Formula{};
+        }
+        return formula;
+    }
+    return impl_->parse(file);
+}
+
+Formula Parser::parse_dimacs_string(const std::string& text) {
+    impl_->error_message.clear();
+    impl_->has_error_flag = false;
+
+    std::istringstream input(text);
+    return impl_->parse(input);
+}
+
+Formula Parser::parse_aiger(const std::string& filename) {
+    impl_->error_message.clear();
+    impl_->has_error_flag = false;
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        impl_->error_message = "Could not open file: " + filename;
+        impl_->has_error_flag = true;
+        return Formula{};
+    }
     Formula formula;
+    if (!read_aiger(file, formula, impl_->error_message)) {
+        impl_->has_error_flag = true;
+        return Formula{};
+    }
+    return formula;
+}
+
+Formula Parser::parse_expression(const std::string& filename, bool negate) {
+    impl_->error_message.clear();
+    impl_->has_error_flag = false;
+
     std::ifstream file(filename);
     if (!file.is_open()) {
         impl_->error_message = "Could not open file: " + filename;
         impl_->has_error_flag = true;
         return Formula{};
     }
-    
-    // Track maximum variable number for validation
-    int num_vars = 0;
+    return impl_->parse_expression(file, negate);
+}
+
+Formula Parser::parse_expression_string(const std::string& text, bool negate) {
+    impl_->error_message.clear();
+    impl_->has_error_flag = false;
+
+    std::istringstream input(text);
+    return impl_->parse_expression(input, negate);
+}
+
+Formula Parser::Impl::parse_expression(std::istream& input, bool negate) {
+    Formula formula;
+    if (!read_expression(input, negate, formula, atom_names, error_message)) {
+        has_error_flag = true;
+        atom_names.clear();
+        return Formula{};
+    }
+    return formula;
+}
+
+const std::vector<std::string>& Parser::atom_names() const {
+    return impl_->atom_names;
+}
+
+Formula Parser::parse_file(const std::string& filename) {
+    TraceSpan span("parse");
+    auto has_suffix = [&filename](const std::string& suffix) {
+        return filename.size() >= suffix.size() &&
+               filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    if (has_suffix(".aag") || has_suffix(".aig")) {
+        return parse_aiger(filename);
+    }
+    if (has_suffix(".prop")) {
+        return parse_expression(filename);
+    }
+    return parse_dimacs(filename);
+}
+
+Formula Parser::Impl::parse(std::istream& input) {
+    Formula formula;
+    DimacsLineParser lines;
+    std::vector<int> literals;
     std::string line;
-    
-    while (std::getline(file, line)) {
-        // Skip empty lines and comments
-        if (line.empty() || line[0] == 'c') {
-            continue;
-        }
-        
-        // Parse problem line
-        if (line[0] == 'p') {
-            std::istringstream iss(line);
-            std::string p, cnf;
-            iss >> p >> cnf >> num_vars;
-            if (p != "p" || cnf != "cnf") {
-                impl_->error_message = "Invalid problem line format";
-                impl_->has_error_flag = true;
-                return Formula{};
-            }
-            continue;
-        }
-        
-        // Parse clause
-        std::vector<int> clause;
-        std::istringstream iss(line);
-        int lit;
-        while (iss >> lit && lit != 0) {
-            // Validate literal is within bounds
-            if (std::abs(lit) > num_vars) {
-                impl_->error_message = "Variable number exceeds declared maximum";
-                impl_->has_error_flag = true;
+    while (std::getline(input, line)) {
+        switch (lines.parse(line.data(), line.data() + line.size(), literals)) {
+            case DimacsLineParser::Line::Clause:
+                formula.add_clause(literals);
+                break;
+            case DimacsLineParser::Line::Xor:
+                formula.add_xor(literals);
+                break;
+            case DimacsLineParser::Line::Error:
+                error_message = lines.error();
+                has_error_flag = true;
                 return Formula{};
-            }
-            clause.push_back(lit);
-        }
-        
-        if (!clause.empty()) {
-            formula.add_clause(clause);
+            case DimacsLineParser::Line::Skip:
+                break;
         }
     }
-    
     return formula;
 }
 
+void Parser::set_pipelined(bool enabled) {
+    impl_->pipelined = enabled;
+}
+
 bool Parser::has_error() const {
     return impl_->has_error_flag;
 }
@@ -2,6 +2,7 @@
 
 #include "../core/formula.hpp"
 #include <string>
+#include <vector>
 
 namespace stalmarck {
 
@@ -12,6 +13,24 @@ public:
 
     // Parsing methods
     Formula parse_dimacs(const std::string& filename);
+    Formula parse_dimacs_string(const std::string& text); // DIMACS held in memory
+    Formula parse_aiger(const std::string& filename);        // ASCII or binary AIGER, see aiger.hpp
+
+    // Infix propositional formula, see expression.hpp. It is asserted true,
+    // or false with negate, so that UNSAT means it is a tautology
+    Formula parse_expression(const std::string& filename, bool negate = false);
+    Formula parse_expression_string(const std::string& text, bool negate = false);
+
+    // Atom names of the last parsed expression; atom i is variable i + 1
+    const std::vector<std::string>& atom_names() const;
+
+    // AIGER for .aag and .aig files, expressions for .prop files, DIMACS
+    // for anything else
+    Formula parse_file(const std::string& filename);
+
+    // Read DIMACS files through a pipeline of threads, encoding while
+    // reading (see dimacs.hpp). Same formula, sooner for large files
+    void set_pipelined(bool enabled);
     
     // Error handling
     bool has_error() const;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace stalmarck {
+
+// Assignment packed two bits per variable into 64-bit words: 00 unassigned,
+// 01 true, 10 false. It does not own its storage; the solver carves the
+// words from its arena. Reads and writes touch one word, and clearing or
+// saving the whole assignment is a plain word copy.
+class PackedAssignment {
+public:
+    static constexpr size_t VARS_PER_WORD = 32;
+
+    static size_t words_for(size_t num_vars) {
+        return (num_vars + VARS_PER_WORD - 1) / VARS_PER_WORD;
+    }
+
+    // Use words[0..words_for(num_vars)) as storage, keeping its contents
+    void attach(uint64_t* words, size_t num_vars) {
+        words_ = words;
+        num_words_ = words_for(num_vars);
+    }
+
+    // 0 unassigned, 1 true, -1 false
+    int8_t value(int var) const {
+        static constexpr int8_t decode[4] = {0, 1, -1, 0};
+        return decode[(words_[var / VARS_PER_WORD] >> shift(var)) & 3];
+    }
+
+    void set(int var, int8_t value) {
+        uint64_t code = value > 0 ? 1 : (value < 0 ? 2 : 0);
+        uint64_t& word = words_[var / VARS_PER_WORD];
+        word = (word & ~(uint64_t{3} << shift(var))) | (code << shift(var));
+    }
+
+    // Unassign every variable
+    void clear() {
+        std::fill(words_, words_ + num_words_, 0);
+    }
+
+    // Copy the words to out, which must hold num_words() of them
+    void save(uint64_t* out) const {
+        std::copy(words_, words_ + num_words_, out);
+    }
+
+    // Expand to one byte per variable, as the probing interfaces take it
+    void unpack(int8_t* out, size_t num_vars) const {
+        for (size_t var = 0; var < num_vars; ++var) {
+            out[var] = value(static_cast<int>(var));
+        }
+    }
+
+    size_t num_words() const {
+        return num_words_;
+    }
+
+private:
+    static unsigned shift(int var) {
+        return 2 * (static_cast<unsigned>(var) % VARS_PER_WORD);
+    }
+
+    uint64_t* words_ = nullptr;
+    size_t num_words_ = 0;
+};
+
+} // namespace stalmarck
@@ -0,0 +1,114 @@
+#include "solver/exchange.hpp"
+#include <algorithm>
+
+namespace stalmarck {
+
+namespace {
+
+// A slot that has not been written this long after later facts were
+// published belongs to a writer that dropped its fact; readers move past it
+constexpr uint64_t abandoned_slot_lag = 64;
+
+int32_t pack_header(const Fact& fact) {
+    uint32_t header = static_cast<uint32_t>(fact.kind) |
+                      (static_cast<uint32_t>(fact.size) << 8) |
+                      (static_cast<uint32_t>(fact.source) << 16);
+    return static_cast<int32_t>(header);
+}
+
+void unpack_header(int32_t word, Fact& fact) {
+    uint32_t header = static_cast<uint32_t>(word);
+    fact.kind = static_cast<FactKind>(header & 0xff);
+    fact.size = static_cast<uint8_t>((header >> 8) & 0xff);
+    fact.source = static_cast<uint16_t>(header >> 16);
+}
+
+} // namespace
+
+FactExchange::FactExchange(size_t capacity) {
+    size_t size = 1;
+    while (size < std::max<size_t>(capacity, 2)) {
+        size <<= 1;
+    }
+    slots_ = std::make_unique<Slot[]>(size);
+    mask_ = size - 1;
+}
+
+bool FactExchange::publish(const Fact& fact) {
+    uint64_t position = write_position_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[position & mask_];
+
+    // Claim the slot from a settled older lap; anything else means another
+    // writer holds it or a newer lap already replaced it
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0 || sequence > 2 * position ||
+        !slot.sequence.compare_exchange_strong(sequence, 2 * position + 1,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t size = std::min<size_t>(fact.size, MAX_FACT_LITERALS);
+    slot.words[0].store(pack_header(fact), std::memory_order_relaxed);
+    for (size_t i = 0; i < size; ++i) {
+        slot.words[1 + i].store(fact.literals[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * position + 2, std::memory_order_release);
+    return true;
+}
+
+size_t FactExchange::poll(ExchangeCursor& cursor, std::vector<Fact>& out, size_t max_facts) const {
+    uint64_t end = write_position_.load(std::memory_order_acquire);
+    uint64_t capacity = mask_ + 1;
+    if (end - cursor.position > capacity) {
+        cursor.position = end - capacity; // lapped: the older facts are gone
+    }
+
+    size_t read = 0;
+    while (cursor.position < end && read < max_facts) {
+        uint64_t position = cursor.position;
+        const Slot& slot = slots_[position & mask_];
+        uint64_t expected = 2 * position + 2;
+
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before < expected) {
+            // Still being written, or abandoned by a writer that dropped it
+            if (end - position > abandoned_slot_lag) {
+                cursor.position++;
+                continue;
+            }
+            break;
+        }
+        if (before > expected) {
+            cursor.position++; // overwritten by a later lap
+            continue;
+        }
+
+        Fact fact;
+        unpack_header(slot.words[0].load(std::memory_order_relaxed), fact);
+        size_t size = std::min<size_t>(fact.size, MAX_FACT_LITERALS);
+        for (size_t i = 0; i < size; ++i) {
+            fact.literals[i] = slot.words[1 + i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+
+        cursor.position++;
+        if (after == before) {
+            out.push_back(fact);
+            read++;
+        }
+    }
+    return read;
+}
+
+uint64_t FactExchange::published() const {
+    return write_position_.load(std::memory_order_relaxed);
+}
+
+size_t FactExchange::capacity() const {
+    return mask_ + 1;
+}
+
+} // namespace stalmarck
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace stalmarck {
+
+enum class FactKind : uint8_t {
+    Unit,        // literals[0] holds
+    Equivalence, // literals[0] <-> literals[1]
+    Clause       // at least one of literals[0..size) holds
+};
+
+constexpr size_t MAX_FACT_LITERALS = 8;
+
+// A fact derived by one solver that holds for the whole formula
+struct Fact {
+    FactKind kind = FactKind::Unit;
+    uint8_t size = 0;
+    uint16_t source = 0; // publishing solver, so it can skip its own facts
+    std::array<int, MAX_FACT_LITERALS> literals{};
+};
+
+// Read position of one consumer
+struct ExchangeCursor {
+    uint64_t position = 0;
+};
+
+// Lock-free broadcast ring for sharing facts between solver threads. Any
+// number of threads publish and any number read, each with its own cursor.
+//
+// Slots are fixed-size and reused in place, so nothing is ever freed and no
+// reclamation scheme is needed. Each slot carries a sequence word: a writer
+// claims the slot by moving it to an odd value, fills it and publishes
+// 2 * position + 2; a reader copies the slot and keeps the copy only if the
+// sequence was that value before and after. Sharing is lossy by design: a
+// reader that falls a full ring behind skips ahead, and a writer that meets
+// a slot still being written drops its fact.
+class FactExchange {
+public:
+    explicit FactExchange(size_t capacity = 4096); // rounded up to a power of two
+
+    FactExchange(const FactExchange&) = delete;
+    FactExchange& operator=(const FactExchange&) = delete;
+
+    // False if the fact was dropped
+    bool publish(const Fact& fact);
+
+    // Append facts published since the cursor, at most max_facts
+    size_t poll(ExchangeCursor& cursor, std::vector<Fact>& out, size_t max_facts = 256) const;
+
+    uint64_t published() const;
+    size_t capacity() const;
+
+private:
+    // Payload words: kind, size and source packed in the first, then literals
+    static constexpr size_t SLOT_WORDS = 1 + MAX_FACT_LITERALS;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::array<std::atomic<int32_t>, SLOT_WORDS> words{};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    std::atomic<uint64_t> write_position_{0};
+};
+
+} // namespace stalmarck
@@ -0,0 +1,178 @@
+#include "solver/gauss.hpp"
+#include <cstdlib>
+#include <map>
+
+namespace stalmarck {
+
+bool GaussElimination::init(const std::vector<XorConstraint>& xors) {
+    columns_.clear();
+    for (const auto& constraint : xors) {
+        columns_.insert(columns_.end(), constraint.variables.begin(), constraint.variables.end());
+    }
+    std::sort(columns_.begin(), columns_.end());
+    columns_.erase(std::unique(columns_.begin(), columns_.end()), columns_.end());
+
+    words_ = (columns_.size() + 63) / 64;
+    matrix_.assign(xors.size() * words_, 0);
+    rhs_.assign(xors.size(), 0);
+    for (size_t r = 0; r < xors.size(); ++r) {
+        for (int var : xors[r].variables) {
+            size_t c = std::lower_bound(columns_.begin(), columns_.end(), var) - columns_.begin();
+            row(r)[c / 64] ^= uint64_t{1} << (c % 64);
+        }
+        rhs_[r] = xors[r].rhs ? 1 : 0;
+    }
+
+    // Gauss-Jordan elimination to reduced row echelon form
+    size_t rank = 0;
+    pivot_.clear();
+    for (size_t c = 0; c < columns_.size() && rank < rhs_.size(); ++c) {
+        size_t r = rank;
+        while (r < rhs_.size() && !test(r, c)) {
+            r++;
+        }
+        if (r == rhs_.size()) {
+            continue;
+        }
+        if (r != rank) {
+            std::swap_ranges(row(r), row(r) + words_, row(rank));
+            std::swap(rhs_[r], rhs_[rank]);
+        }
+        for (size_t s = 0; s < rhs_.size(); ++s) {
+            if (s != rank && test(s, c)) {
+                add_row(s, rank);
+            }
+        }
+        pivot_.push_back(static_cast<int>(c));
+        rank++;
+    }
+
+    // The rows past the rank are all zero: 0 = 1 is a contradiction, 0 = 0
+    // says nothing
+    for (size_t r = rank; r < rhs_.size(); ++r) {
+        if (rhs_[r]) {
+            return false;
+        }
+    }
+    matrix_.resize(rank * words_);
+    rhs_.resize(rank);
+    assigned_.assign(words_, 0);
+    true_.assign(words_, 0);
+    return true;
+}
+
+void GaussElimination::add_row(size_t target, size_t source) {
+    uint64_t* t = row(target);
+    const uint64_t* s = row(source);
+    for (size_t w = 0; w < words_; ++w) {
+        t[w] ^= s[w];
+    }
+    rhs_[target] ^= rhs_[source];
+}
+
+void GaussElimination::repivot() {
+    for (size_t r = 0; r < rhs_.size(); ++r) {
+        int p = pivot_[r];
+        if (p >= 0 && ((assigned_[p / 64] >> (p % 64)) & 1) == 0) {
+            continue;
+        }
+        // Other rows' pivot columns are clear in this row, so any
+        // unassigned column will do
+        const uint64_t* bits = row(r);
+        int c = -1;
+        for (size_t w = 0; w < words_; ++w) {
+            uint64_t open = bits[w] & ~assigned_[w];
+            if (open != 0) {
+                c = static_cast<int>(w * 64 + __builtin_ctzll(open));
+                break;
+            }
+        }
+        pivot_[r] = c;
+        if (c < 0) {
+            continue;
+        }
+        for (size_t s = 0; s < rhs_.size(); ++s) {
+            if (s != r && test(s, c)) {
+                add_row(s, r);
+            }
+        }
+    }
+}
+
+GaussElimination::Row GaussElimination::check_row(size_t r, int& unit) {
+    const uint64_t* bits = row(r);
+    size_t open_count = 0;
+    size_t open_word = 0;
+    unsigned parity = rhs_[r];
+    for (size_t w = 0; w < words_; ++w) {
+        uint64_t open = bits[w] & ~assigned_[w];
+        if (open != 0) {
+            open_count += __builtin_popcountll(open);
+            if (open_count > 1) {
+                return Row::Open;
+            }
+            open_word = w;
+        }
+        parity ^= __builtin_popcountll(bits[w] & true_[w]) & 1;
+    }
+    if (open_count == 0) {
+        return parity != 0 ? Row::Conflict : Row::Open;
+    }
+    // The rest of the row leaves `parity` for the open variable
+    uint64_t open = bits[open_word] & ~assigned_[open_word];
+    int c = static_cast<int>(open_word * 64 + __builtin_ctzll(open));
+    unit = 2 * c + static_cast<int>(parity);
+    return Row::Unit;
+}
+
+size_t extract_xors(Formula& formula, size_t max_size) {
+    // Variable set -> negation masks of the clauses over it
+    std::map<std::vector<int>, std::vector<uint32_t>> groups;
+    std::vector<int> clause;
+    for (const auto& original : formula.get_clauses()) {
+        if (original.size() < 3 || original.size() > max_size) {
+            continue;
+        }
+        clause = original;
+        std::sort(clause.begin(), clause.end(), [](int a, int b) { return std::abs(a) < std::abs(b); });
+        std::vector<int> vars;
+        uint32_t mask = 0;
+        bool repeated = false;
+        for (size_t i = 0; i < clause.size(); ++i) {
+            repeated |= i > 0 && std::abs(clause[i]) == std::abs(clause[i - 1]);
+            vars.push_back(std::abs(clause[i]));
+            mask |= clause[i] < 0 ? uint32_t{1} << i : 0;
+        }
+        if (!repeated) {
+            groups[std::move(vars)].push_back(mask);
+        }
+    }
+
+    size_t found = 0;
+    for (auto& [vars, masks] : groups) {
+        std::sort(masks.begin(), masks.end());
+        masks.erase(std::unique(masks.begin(), masks.end()), masks.end());
+        size_t needed = size_t{1} << (vars.size() - 1);
+        for (unsigned parity : {0u, 1u}) {
+            size_t count = 0;
+            for (uint32_t mask : masks) {
+                count += (__builtin_popcount(mask) & 1u) == parity;
+            }
+            if (count != needed) {
+                continue;
+            }
+            // Each clause excludes the assignment falsifying it, whose
+            // true variables are its negated ones: every assignment of
+            // this parity is excluded, so the variables XOR to the other
+            std::vector<int> literals(vars);
+            if (parity == 1) {
+                literals[0] = -literals[0];
+            }
+            formula.add_xor(literals);
+            found++;
+        }
+    }
+    return found;
+}
+
+} // namespace stalmarck
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../core/formula.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace stalmarck {
+
+// XOR constraints as a GF(2) matrix, one bit-packed row per constraint and
+// one column per variable they mention, propagated by Gauss-Jordan
+// elimination alongside the triplet rules.
+//
+// The matrix is kept in reduced row echelon form with every pivot on an
+// unassigned variable where the row has one. A row with one unassigned
+// variable left forces it, and a fully assigned row with the wrong parity
+// is a conflict; with the pivots kept unassigned, these are all the
+// consequences the constraints have under the current assignment. When a
+// pivot gets assigned, the row moves its pivot to another unassigned
+// column and clears that column from the other rows. Row operations never
+// change the constraints' solutions, so backtracking needs no undo.
+class GaussElimination {
+public:
+    // Returns false if the constraints contradict each other
+    bool init(const std::vector<XorConstraint>& xors);
+
+    size_t num_rows() const { return rhs_.size(); }
+
+    // Propagate under the assignment `view` gives (value(var) is 0, 1 or -1;
+    // assign(var, value)), setting changed when something was assigned.
+    // Returns false on a conflict.
+    template <class View>
+    bool propagate(View& view, bool& changed) {
+        if (rhs_.empty()) {
+            return true;
+        }
+        std::fill(assigned_.begin(), assigned_.end(), 0);
+        std::fill(true_.begin(), true_.end(), 0);
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            int8_t value = view.value(columns_[c]);
+            if (value != 0) {
+                assigned_[c / 64] |= uint64_t{1} << (c % 64);
+                if (value > 0) {
+                    true_[c / 64] |= uint64_t{1} << (c % 64);
+                }
+            }
+        }
+        repivot();
+        for (size_t r = 0; r < rhs_.size(); ++r) {
+            int unit = 0;
+            switch (check_row(r, unit)) {
+                case Row::Conflict:
+                    return false;
+                case Row::Unit:
+                    view.assign(columns_[unit >> 1], (unit & 1) != 0);
+                    changed = true;
+                    break;
+                case Row::Open:
+                    break;
+            }
+        }
+        return true;
+    }
+
+private:
+    enum class Row { Open, Unit, Conflict };
+
+    uint64_t* row(size_t r) { return &matrix_[r * words_]; }
+    bool test(size_t r, size_t c) const { return (matrix_[r * words_ + c / 64] >> (c % 64)) & 1; }
+
+    // rows[target] ^= rows[source]
+    void add_row(size_t target, size_t source);
+
+    // Move pivots off assigned columns, clearing each new pivot column
+    // from the other rows
+    void repivot();
+
+    // Unit sets unit to 2 * column + value
+    Row check_row(size_t r, int& unit);
+
+    std::vector<int> columns_;       // column -> variable
+    size_t words_ = 0;               // 64-bit words per row
+    std::vector<uint64_t> matrix_;   // rows, words_ words each
+    std::vector<uint8_t> rhs_;
+    std::vector<int> pivot_;         // row -> pivot column, -1 if none
+    std::vector<uint64_t> assigned_; // per column, refreshed on each propagate
+    std::vector<uint64_t> true_;
+};
+
+// Find XOR constraints encoded as clauses: for k variables, the 2^(k-1)
+// clauses over them whose negation counts share a parity. They are added
+// to the formula's XOR constraints and the clauses stay, so only
+// propagation changes. Looks at clauses of 3 to max_size literals.
+// Returns the number found.
+size_t extract_xors(Formula& formula, size_t max_size = 5);
+
+} // namespace stalmarck
@@ -0,0 +1,263 @@
+#include "solver/inprocess.hpp"
+#include "solver/rules.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace stalmarck {
+
+namespace {
+
+// Literal l as a node of the implication graph
+size_t node_of(int lit) {
+    return 2 * static_cast<size_t>(std::abs(lit)) + (lit < 0 ? 1 : 0);
+}
+
+int literal_of(size_t node) {
+    int var = static_cast<int>(node / 2);
+    return (node & 1) ? -var : var;
+}
+
+// Implication graph in compressed adjacency form
+struct ImplicationGraph {
+    std::vector<size_t> start; // edges of node n are targets[start[n] .. start[n + 1])
+    std::vector<size_t> targets;
+
+    ImplicationGraph(const std::vector<std::tuple<int, int, int>>& triplets, size_t num_nodes) {
+        std::vector<std::pair<size_t, size_t>> edges;
+        edges.reserve(4 * triplets.size());
+        auto add = [&edges](int from, int to) {
+            if (from != 0 && to != 0) {
+                edges.emplace_back(node_of(from), node_of(to));
+            }
+        };
+        for (const auto& [x, y, z] : triplets) {
+            add(-x, y);
+            add(-y, x);
+            add(-x, -z);
+            add(z, x);
+        }
+
+        start.assign(num_nodes + 1, 0);
+        for (const auto& edge : edges) {
+            start[edge.first + 1]++;
+        }
+        for (size_t n = 0; n < num_nodes; ++n) {
+            start[n + 1] += start[n];
+        }
+        targets.resize(edges.size());
+        std::vector<size_t> fill(start.begin(), start.end() - 1);
+        for (const auto& edge : edges) {
+            targets[fill[edge.first]++] = edge.second;
+        }
+    }
+};
+
+// Tarjan's algorithm without recursion; returns the component of each node
+std::vector<size_t> strongly_connected_components(const ImplicationGraph& graph, size_t num_nodes) {
+    const size_t unvisited = static_cast<size_t>(-1);
+    std::vector<size_t> index(num_nodes, unvisited);
+    std::vector<size_t> low(num_nodes, 0);
+    std::vector<size_t> component(num_nodes, unvisited);
+    std::vector<size_t> stack;
+    std::vector<std::pair<size_t, size_t>> calls; // node, next edge
+    size_t next_index = 0;
+    size_t next_component = 0;
+
+    for (size_t root = 0; root < num_nodes; ++root) {
+        if (index[root] != unvisited) {
+            continue;
+        }
+        calls.emplace_back(root, graph.start[root]);
+        index[root] = low[root] = next_index++;
+        stack.push_back(root);
+
+        while (!calls.empty()) {
+            auto& [node, edge] = calls.back();
+            if (edge < graph.start[node + 1]) {
+                size_t target = graph.targets[edge++];
+                if (index[target] == unvisited) {
+                    index[target] = low[target] = next_index++;
+                    stack.push_back(target);
+                    calls.emplace_back(target, graph.start[target]);
+                } else if (component[target] == unvisited) {
+                    low[node] = std::min(low[node], index[target]);
+                }
+                continue;
+            }
+
+            // All edges done: close the component if node is its root
+            size_t finished = node;
+            calls.pop_back();
+            if (low[finished] == index[finished]) {
+                size_t member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    component[member] = next_component;
+                } while (member != finished);
+                next_component++;
+            }
+            if (!calls.empty()) {
+                size_t parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[finished]);
+            }
+        }
+    }
+    return component;
+}
+
+} // namespace
+
+bool find_equivalent_literals(const std::vector<std::tuple<int, int, int>>& triplets,
+                              size_t max_var, std::vector<int>& representative) {
+    size_t num_nodes = 2 * (max_var + 1);
+    ImplicationGraph graph(triplets, num_nodes);
+    std::vector<size_t> component = strongly_connected_components(graph, num_nodes);
+
+    // The literal with the smallest variable stands for its component; the
+    // graph is its own contrapositive, so -l's component gets -rep(l)
+    std::vector<int> component_rep(num_nodes, 0);
+    for (size_t node = 2; node < num_nodes; ++node) {
+        int& rep = component_rep[component[node]];
+        if (rep == 0) {
+            rep = literal_of(node); // nodes are visited in increasing variable order
+        }
+    }
+
+    representative.assign(max_var + 1, 0);
+    for (size_t var = 1; var <= max_var; ++var) {
+        size_t positive = node_of(static_cast<int>(var));
+        if (component[positive] == component[positive + 1]) {
+            return false;
+        }
+        representative[var] = component_rep[component[positive]];
+    }
+    return true;
+}
+
+size_t substitute_equivalent_literals(std::vector<std::tuple<int, int, int>>& triplets,
+                                      const std::vector<int>& representative) {
+    size_t substituted = 0;
+    for (size_t var = 1; var < representative.size(); ++var) {
+        if (representative[var] != static_cast<int>(var)) {
+            substituted++;
+        }
+    }
+    if (substituted == 0) {
+        return 0;
+    }
+
+    auto rewrite = [&representative](int lit) {
+        if (lit == 0 || static_cast<size_t>(std::abs(lit)) >= representative.size()) {
+            return lit;
+        }
+        return lit > 0 ? representative[lit] : -representative[-lit];
+    };
+    for (auto& [x, y, z] : triplets) {
+        x = rewrite(x);
+        y = rewrite(y);
+        z = rewrite(z);
+    }
+
+    // Drop duplicates, keeping the first occurrence so the order (and any
+    // locality it encodes) survives
+    std::vector<size_t> order(triplets.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&triplets](size_t a, size_t b) { return triplets[a] < triplets[b]; });
+    std::vector<bool> duplicate(triplets.size(), false);
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (triplets[order[i]] == triplets[order[i - 1]]) {
+            duplicate[order[i]] = true;
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < triplets.size(); ++i) {
+        if (!duplicate[i]) {
+            triplets[kept++] = triplets[i];
+        }
+    }
+    triplets.resize(kept);
+    return substituted;
+}
+
+bool probe_failed_literals(const std::vector<std::tuple<int, int, int>>& triplets,
+                           const TripletKindOffsets* groups,
+                           const int8_t* values, size_t num_values,
+                           const std::vector<int>& variables, size_t max_probes,
+                           std::vector<int>& units) {
+    ProbeScratch scratch;
+    return probe_failed_literals(triplets, groups, values, num_values, variables, max_probes, units, scratch);
+}
+
+bool probe_failed_literals(const std::vector<std::tuple<int, int, int>>& triplets,
+                           const TripletKindOffsets* groups,
+                           const int8_t* values, size_t num_values,
+                           const std::vector<int>& variables, size_t max_probes,
+                           std::vector<int>& units, ProbeScratch& scratch) {
+    if (scratch.overlay.size() < num_values) {
+        scratch.overlay.resize(num_values, 0);
+        scratch.first.resize(num_values, 0);
+    }
+    int8_t* overlay = scratch.overlay.data();
+    int8_t* first = scratch.first.data(); // outcome of the true probe
+    std::vector<int>& touched = scratch.touched;
+    std::vector<int>& first_touched = scratch.first_touched;
+    touched.clear();
+    rules::OverlayView view{values, overlay, &touched};
+
+    auto clear = [&]() {
+        for (int var : touched) {
+            overlay[var] = 0;
+        }
+        touched.clear();
+    };
+
+    size_t probes = 0;
+    for (int var : variables) {
+        if (probes++ == max_probes) {
+            break;
+        }
+        if (values[var] != 0) {
+            continue;
+        }
+
+        view.assign(var, true);
+        bool true_failed = !rules::saturate(view, triplets, groups);
+        first_touched.clear();
+        if (!true_failed) {
+            first_touched.assign(touched.begin(), touched.end());
+            for (int implied : touched) {
+                first[implied] = overlay[implied];
+            }
+        }
+        clear();
+
+        view.assign(var, false);
+        bool false_failed = !rules::saturate(view, triplets, groups);
+        if (true_failed && false_failed) {
+            clear();
+            return false;
+        }
+        if (true_failed || false_failed) {
+            units.push_back(true_failed ? -var : var);
+        } else {
+            // Literals both polarities agree on
+            for (int implied : touched) {
+                if (implied != var && first[implied] == overlay[implied]) {
+                    units.push_back(overlay[implied] > 0 ? implied : -implied);
+                }
+            }
+        }
+        clear();
+        for (int implied : first_touched) {
+            first[implied] = 0;
+        }
+    }
+    return true;
+}
+
+} // namespace stalmarck
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../core/formula.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+namespace stalmarck {
+
+// Simplification passes the solver runs on its working copy of the triplets
+// between search steps.
+
+// Equivalent literals from the strongly connected components of the binary
+// implications every triplet x <-> (y -> z) carries: -x -> y, -y -> x,
+// -x -> -z and z -> x. On return representative[v] is the literal that
+// stands for variable v (v itself when it has no smaller equivalent).
+// Returns false if a literal is equivalent to its own negation.
+bool find_equivalent_literals(const std::vector<std::tuple<int, int, int>>& triplets,
+                              size_t max_var, std::vector<int>& representative);
+
+// Rewrite every literal through representative and drop duplicate triplets;
+// returns the number of variables substituted away
+size_t substitute_equivalent_literals(std::vector<std::tuple<int, int, int>>& triplets,
+                                      const std::vector<int>& representative);
+
+// Failed-literal probing: propagate both polarities of each variable on a
+// copy-on-write view of values and collect the literals that hold in every
+// consistent outcome - the negation of a failed literal, and any literal
+// implied by both polarities. Stops early once max_probes variables have
+// been probed. Returns false if both polarities of a variable fail.
+bool probe_failed_literals(const std::vector<std::tuple<int, int, int>>& triplets,
+                           const TripletKindOffsets* groups,
+                           const int8_t* values, size_t num_values,
+                           const std::vector<int>& variables, size_t max_probes,
+                           std::vector<int>& units);
+
+// Buffers probe_failed_literals works in. A solver keeps one across calls,
+// so probing during search stops allocating once they fit the formula;
+// overlay and first are all zero between calls.
+struct ProbeScratch {
+    std::vector<int8_t> overlay;
+    std::vector<int8_t> first;
+    std::vector<int> touched;
+    std::vector<int> first_touched;
+};
+
+bool probe_failed_literals(const std::vector<std::tuple<int, int, int>>& triplets,
+                           const TripletKindOffsets* groups,
+                           const int8_t* values, size_t num_values,
+                           const std::vector<int>& variables, size_t max_probes,
+                           std::vector<int>& units, ProbeScratch& scratch);
+
+} // namespace stalmarck
@@ -0,0 +1,437 @@
+#include "solver/local_search.hpp"
+#include "core/trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace stalmarck {
+
+namespace {
+
+// Clock and stop flag are checked once per this many flips
+constexpr uint64_t check_interval = 4096;
+
+// Break counts past this share the last probability
+constexpr size_t max_tabulated_break = 64;
+
+// Literal of variable v as 2v, its negation as 2v + 1
+inline uint32_t encode_literal(int lit) {
+    return 2 * static_cast<uint32_t>(std::abs(lit)) + (lit < 0 ? 1 : 0);
+}
+
+// xorshift64*: quick, and good enough to pick clauses and variables
+class Random {
+public:
+    explicit Random(uint64_t seed) : state_(seed != 0 ? seed : 0x9e3779b97f4a7c15ULL) {}
+
+    uint64_t next() {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 0x2545f4914f6cdd1dULL;
+    }
+
+    uint32_t below(uint32_t bound) {
+        return static_cast<uint32_t>(((next() >> 32) * bound) >> 32);
+    }
+
+    double unit() {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    uint64_t state_;
+};
+
+} // namespace
+
+class LocalSearch::Impl {
+public:
+    uint64_t seed = 1;
+    double timeout = 0.0;
+    uint64_t max_flips = 0;
+    const std::atomic<bool>* stop_flag = nullptr;
+
+    // Flat clause arena: clause c is literals[starts[c]..starts[c + 1])
+    size_t num_variables = 0;
+    std::vector<uint32_t> literals;
+    std::vector<uint32_t> starts;
+
+    // Clauses containing each literal: occurrences[occurrence_starts[l]..]
+    std::vector<uint32_t> occurrence_starts;
+    std::vector<uint32_t> occurrences;
+
+    // Per clause, the number of true literals and the XOR of their
+    // variables, which is the only true variable when the count is 1
+    struct ClauseState {
+        uint32_t true_count;
+        uint32_t true_xor;
+    };
+    std::vector<ClauseState> clause_state;
+
+    std::vector<uint64_t> bits; // bit v set: variable v is true
+    std::vector<uint32_t> breaks; // clauses only this variable satisfies
+    std::vector<uint32_t> makes;  // unsatisfied clauses containing it
+    std::vector<uint32_t> unsatisfied;
+    std::vector<uint32_t> unsatisfied_position; // index in unsatisfied, per clause
+
+    // The best assignment is the current one with these flips undone,
+    // until the list outgrows the variables and it is copied to best_bits
+    std::vector<uint32_t> flips_since_best;
+    std::vector<uint64_t> best_bits;
+    bool best_copied = false;
+    size_t best = 0;
+
+    // probSAT: a variable is picked with weight probabilities[break]
+    std::vector<double> probabilities;
+    std::vector<double> weights;
+
+    uint64_t flips = 0;
+    std::vector<int> model;
+    std::vector<int> best_assignment;
+
+    bool value(uint32_t var) const {
+        return (bits[var >> 6] >> (var & 63)) & 1;
+    }
+
+    bool is_true(uint32_t lit) const {
+        return value(lit >> 1) != (lit & 1);
+    }
+
+    // Load the clauses, dropping repeated literals and tautologies; false
+    // when a clause is empty
+    bool build(const Formula& formula) {
+        num_variables = formula.num_variables();
+        for (const auto& clause : formula.get_clauses()) {
+            for (int lit : clause) {
+                num_variables = std::max(num_variables, static_cast<size_t>(std::abs(lit)));
+            }
+        }
+
+        literals.clear();
+        starts.assign(1, 0);
+        std::vector<uint32_t> clause_literals;
+        for (const auto& clause : formula.get_clauses()) {
+            clause_literals.clear();
+            for (int lit : clause) {
+                clause_literals.push_back(encode_literal(lit));
+            }
+            std::sort(clause_literals.begin(), clause_literals.end());
+            clause_literals.erase(std::unique(clause_literals.begin(), clause_literals.end()),
+                                  clause_literals.end());
+            if (clause_literals.empty()) {
+                return false;
+            }
+            bool tautology = false;
+            for (size_t i = 1; i < clause_literals.size(); ++i) {
+                tautology |= clause_literals[i] == (clause_literals[i - 1] ^ 1);
+            }
+            if (!tautology) {
+                literals.insert(literals.end(), clause_literals.begin(), clause_literals.end());
+                starts.push_back(static_cast<uint32_t>(literals.size()));
+            }
+        }
+
+        // Occurrence lists by counting sort
+        size_t num_literals = 2 * (num_variables + 1);
+        occurrence_starts.assign(num_literals + 1, 0);
+        for (uint32_t lit : literals) {
+            occurrence_starts[lit + 1]++;
+        }
+        for (size_t l = 0; l < num_literals; ++l) {
+            occurrence_starts[l + 1] += occurrence_starts[l];
+        }
+        occurrences.resize(literals.size());
+        std::vector<uint32_t> fill(occurrence_starts.begin(), occurrence_starts.end() - 1);
+        for (uint32_t c = 0; c + 1 < starts.size(); ++c) {
+            for (uint32_t i = starts[c]; i < starts[c + 1]; ++i) {
+                occurrences[fill[literals[i]]++] = c;
+            }
+        }
+        return true;
+    }
+
+    // probSAT's break-only weights for the clause length: polynomial for
+    // 3-SAT, exponential for longer clauses
+    void tabulate_probabilities() {
+        size_t num_clauses = starts.size() - 1;
+        double length = num_clauses > 0 ? static_cast<double>(literals.size()) / num_clauses : 3.0;
+        probabilities.resize(max_tabulated_break + 1);
+        for (size_t b = 0; b <= max_tabulated_break; ++b) {
+            double x = static_cast<double>(b);
+            if (length < 3.5) {
+                probabilities[b] = std::pow(0.9 + x, -2.06);
+            } else {
+                double base = length < 4.5 ? 3.0 : length < 5.5 ? 3.7 : length < 6.5 ? 5.1 : 5.4;
+                probabilities[b] = std::pow(base, -x);
+            }
+        }
+    }
+
+    void initialize(Random& random) {
+        size_t num_clauses = starts.size() - 1;
+        bits.assign(num_variables / 64 + 1, 0);
+        for (auto& word : bits) {
+            word = random.next();
+        }
+        breaks.assign(num_variables + 1, 0);
+        makes.assign(num_variables + 1, 0);
+        clause_state.assign(num_clauses, ClauseState{0, 0});
+        unsatisfied.clear();
+        unsatisfied_position.assign(num_clauses, 0);
+        for (uint32_t c = 0; c < num_clauses; ++c) {
+            ClauseState& state = clause_state[c];
+            for (uint32_t i = starts[c]; i < starts[c + 1]; ++i) {
+                if (is_true(literals[i])) {
+                    state.true_count++;
+                    state.true_xor ^= literals[i] >> 1;
+                }
+            }
+            if (state.true_count == 0) {
+                add_unsatisfied(c);
+            } else if (state.true_count == 1) {
+                breaks[state.true_xor]++;
+            }
+        }
+        flips_since_best.clear();
+        best_copied = false;
+        best = unsatisfied.size();
+    }
+
+    void add_unsatisfied(uint32_t c) {
+        unsatisfied_position[c] = static_cast<uint32_t>(unsatisfied.size());
+        unsatisfied.push_back(c);
+        for (uint32_t i = starts[c]; i < starts[c + 1]; ++i) {
+            makes[literals[i] >> 1]++;
+        }
+    }
+
+    void remove_unsatisfied(uint32_t c) {
+        uint32_t last = unsatisfied.back();
+        unsatisfied[unsatisfied_position[c]] = last;
+        unsatisfied_position[last] = unsatisfied_position[c];
+        unsatisfied.pop_back();
+        for (uint32_t i = starts[c]; i < starts[c + 1]; ++i) {
+            makes[literals[i] >> 1]--;
+        }
+    }
+
+    void flip(uint32_t var) {
+        bits[var >> 6] ^= uint64_t{1} << (var & 63);
+        uint32_t now_true = 2 * var + (value(var) ? 0 : 1);
+        uint32_t now_false = now_true ^ 1;
+
+        // The clauses are scattered over memory: fetch them all up front so
+        // the misses overlap instead of coming one per clause
+        uint32_t begin = occurrence_starts[std::min(now_true, now_false)];
+        uint32_t end = occurrence_starts[std::max(now_true, now_false) + 1];
+        for (uint32_t o = begin; o < end; ++o) {
+            __builtin_prefetch(&clause_state[occurrences[o]], 1);
+        }
+
+        for (uint32_t o = occurrence_starts[now_true]; o < occurrence_starts[now_true + 1]; ++o) {
+            uint32_t c = occurrences[o];
+            ClauseState& state = clause_state[c];
+            if (state.true_count == 0) {
+                remove_unsatisfied(c);
+                breaks[var]++;
+            } else if (state.true_count == 1) {
+                breaks[state.true_xor]--;
+            }
+            state.true_count++;
+            state.true_xor ^= var;
+        }
+
+        for (uint32_t o = occurrence_starts[now_false]; o < occurrence_starts[now_false + 1]; ++o) {
+            uint32_t c = occurrences[o];
+            ClauseState& state = clause_state[c];
+            state.true_count--;
+            state.true_xor ^= var;
+            if (state.true_count == 0) {
+                add_unsatisfied(c);
+                breaks[var]--;
+            } else if (state.true_count == 1) {
+                breaks[state.true_xor]++;
+            }
+        }
+        flips++;
+    }
+
+    // The variable to flip in unsatisfied clause c
+    uint32_t pick(uint32_t c, Random& random) {
+        uint32_t begin = starts[c];
+        uint32_t end = starts[c + 1];
+
+        // A freebie: a flip that breaks nothing, the most making first
+        uint32_t freebie = 0;
+        for (uint32_t i = begin; i < end; ++i) {
+            uint32_t var = literals[i] >> 1;
+            if (breaks[var] == 0 && (freebie == 0 || makes[var] > makes[freebie])) {
+                freebie = var;
+            }
+        }
+        if (freebie != 0) {
+            return freebie;
+        }
+
+        weights.resize(end - begin);
+        double total = 0.0;
+        for (uint32_t i = begin; i < end; ++i) {
+            uint32_t b = std::min<uint32_t>(breaks[literals[i] >> 1], max_tabulated_break);
+            total += probabilities[b];
+            weights[i - begin] = total;
+        }
+        double r = random.unit() * total;
+        uint32_t i = begin;
+        while (i + 1 < end && weights[i - begin] <= r) {
+            ++i;
+        }
+        return literals[i] >> 1;
+    }
+
+    void record_flip(uint32_t var) {
+        if (best_copied) {
+            return;
+        }
+        flips_since_best.push_back(var);
+        if (flips_since_best.size() > num_variables) {
+            best_bits = bits;
+            for (uint32_t v : flips_since_best) {
+                best_bits[v >> 6] ^= uint64_t{1} << (v & 63);
+            }
+            flips_since_best.clear();
+            best_copied = true;
+        }
+    }
+
+    void record_best() {
+        best = unsatisfied.size();
+        flips_since_best.clear();
+        best_copied = false;
+    }
+
+    void store_best_assignment() {
+        if (!best_copied) {
+            best_bits = bits;
+            for (uint32_t v : flips_since_best) {
+                best_bits[v >> 6] ^= uint64_t{1} << (v & 63);
+            }
+        }
+        best_assignment.resize(num_variables);
+        for (size_t var = 1; var <= num_variables; ++var) {
+            bool true_value = (best_bits[var >> 6] >> (var & 63)) & 1;
+            best_assignment[var - 1] = true_value ? static_cast<int>(var) : -static_cast<int>(var);
+        }
+    }
+
+    bool satisfies_xors(const Formula& formula) const {
+        for (const auto& constraint : formula.get_xors()) {
+            bool parity = false;
+            for (int var : constraint.variables) {
+                parity ^= value(static_cast<uint32_t>(var));
+            }
+            if (parity != constraint.rhs) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void record_model(const Formula& formula) {
+        model.assign(formula.num_variables(), 0);
+        for (size_t var = 1; var <= formula.num_variables(); ++var) {
+            int original = formula.original_variable(static_cast<int>(var));
+            model[original - 1] = value(static_cast<uint32_t>(var)) ? original : -original;
+        }
+    }
+};
+
+LocalSearch::LocalSearch() : impl_(std::make_unique<Impl>()) {}
+LocalSearch::~LocalSearch() = default;
+
+void LocalSearch::set_seed(uint64_t seed) {
+    impl_->seed = seed;
+}
+
+void LocalSearch::set_timeout(double seconds) {
+    impl_->timeout = seconds;
+}
+
+void LocalSearch::set_max_flips(uint64_t flips) {
+    impl_->max_flips = flips;
+}
+
+void LocalSearch::set_stop_flag(const std::atomic<bool>* stop) {
+    impl_->stop_flag = stop;
+}
+
+bool LocalSearch::solve(const Formula& formula) {
+    TraceSpan span("local search");
+    Impl& impl = *impl_;
+    impl.flips = 0;
+    impl.model.clear();
+    impl.best_assignment.clear();
+    impl.best = 0;
+    if (formula.is_structural() || !impl.build(formula)) {
+        return false;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(impl.timeout));
+    Random random(impl.seed);
+    impl.tabulate_probabilities();
+    impl.initialize(random);
+
+    bool satisfied = false;
+    for (;;) {
+        if (impl.unsatisfied.empty()) {
+            // XOR constraints are only checked here; a model of the
+            // clauses that breaks one ends the search
+            satisfied = impl.satisfies_xors(formula);
+            break;
+        }
+        if (impl.max_flips > 0 && impl.flips >= impl.max_flips) {
+            break;
+        }
+        if (impl.flips % check_interval == 0 && impl.flips > 0 &&
+            ((impl.timeout > 0.0 && std::chrono::steady_clock::now() >= deadline) ||
+             (impl.stop_flag && impl.stop_flag->load(std::memory_order_relaxed)))) {
+            break;
+        }
+        uint32_t c = impl.unsatisfied[random.below(static_cast<uint32_t>(impl.unsatisfied.size()))];
+        uint32_t var = impl.pick(c, random);
+        impl.flip(var);
+        if (impl.unsatisfied.size() < impl.best) {
+            impl.record_best();
+        } else {
+            impl.record_flip(var);
+        }
+    }
+
+    if (satisfied) {
+        impl.record_best();
+        impl.record_model(formula);
+    }
+    impl.store_best_assignment();
+    return satisfied;
+}
+
+const std::vector<int>& LocalSearch::get_model() const {
+    return impl_->model;
+}
+
+const std::vector<int>& LocalSearch::get_best_assignment() const {
+    return impl_->best_assignment;
+}
+
+size_t LocalSearch::best_unsatisfied() const {
+    return impl_->best;
+}
+
+uint64_t LocalSearch::flips() const {
+    return impl_->flips;
+}
+
+} // namespace stalmarck
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../core/formula.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace stalmarck {
+
+// Stochastic local search over the clauses, for satisfiable instances the
+// complete search cannot reach: probSAT with WalkSAT's freebie move. Each
+// step takes a random unsatisfied clause and flips one of its variables:
+// one that breaks no clause if there is one (the most making on ties),
+// otherwise one drawn with probability falling with its break count.
+//
+// Clauses live in one flat literal array with per-literal occurrence
+// lists, the assignment is bit-packed, and break and make counts are kept
+// up to date on each flip, so a step costs the occurrences of the flipped
+// variable. It cannot prove UNSAT; when the budget runs out, the best
+// assignment found makes phase hints for the complete search.
+class LocalSearch {
+public:
+    LocalSearch();
+    ~LocalSearch();
+
+    LocalSearch(const LocalSearch&) = delete;
+    LocalSearch& operator=(const LocalSearch&) = delete;
+
+    void set_seed(uint64_t seed);
+    void set_timeout(double seconds);                  // 0 = none
+    void set_max_flips(uint64_t flips);                // 0 = none
+    void set_stop_flag(const std::atomic<bool>* stop); // give up once it is set
+
+    // True when an assignment satisfying every clause and XOR constraint is
+    // found. Structural formulas have no clauses to search and return false
+    bool solve(const Formula& formula);
+
+    // The satisfying assignment after solve() returned true, in the
+    // formula's original variable numbering: entry i is +(i+1) or -(i+1)
+    const std::vector<int>& get_model() const;
+
+    // Assignment with the fewest unsatisfied clauses seen, in the formula's
+    // numbering, as Solver::set_phase_hints takes it
+    const std::vector<int>& get_best_assignment() const;
+    size_t best_unsatisfied() const;
+
+    uint64_t flips() const; // flips made by the last solve
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace stalmarck
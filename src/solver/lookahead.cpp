@@ -0,0 +1,108 @@
+#include "solver/lookahead.hpp"
+#include "solver/rules.hpp"
+#include "core/thread_pool.hpp"
+#include "core/trace.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace stalmarck {
+
+class Lookahead::Impl {
+public:
+    // Per-worker probe state, reused across probes
+    struct Scratch {
+        std::vector<int8_t> overlay;
+        std::vector<int> touched;
+    };
+
+    size_t num_threads = 1;
+    std::unique_ptr<ThreadPool> pool; // only when probing on several threads
+    std::vector<Scratch> scratch;
+    std::vector<ProbeResult> results;
+
+    // Propagate var = value; returns the number of implied assignments and
+    // sets failed on a contradiction
+    size_t probe_literal(Scratch& s, const std::vector<std::tuple<int, int, int>>& triplets,
+                         const TripletKindOffsets* groups, const int8_t* values,
+                         int var, bool value, bool& failed) {
+        rules::OverlayView view{values, s.overlay.data(), &s.touched};
+        view.assign(var, value);
+        failed = !rules::saturate(view, triplets, groups);
+        size_t implied = s.touched.size() - 1;
+
+        for (int touched : s.touched) {
+            s.overlay[touched] = 0;
+        }
+        s.touched.clear();
+        return implied;
+    }
+};
+
+Lookahead::Lookahead(size_t num_threads) : impl_(std::make_unique<Impl>()) {
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    impl_->num_threads = num_threads;
+    if (num_threads > 1) {
+        impl_->pool = std::make_unique<ThreadPool>(num_threads);
+    }
+    impl_->scratch.resize(num_threads);
+}
+
+Lookahead::~Lookahead() = default;
+
+const std::vector<ProbeResult>& Lookahead::probe(const std::vector<std::tuple<int, int, int>>& triplets,
+                                                 const TripletKindOffsets* groups,
+                                                 const int8_t* values, size_t num_values,
+                                                 const std::vector<int>& candidates) {
+    for (auto& s : impl_->scratch) {
+        if (s.overlay.size() < num_values) {
+            s.overlay.assign(num_values, 0);
+        }
+    }
+    impl_->results.assign(candidates.size(), ProbeResult{});
+
+    auto run = [this, &triplets, groups, values, &candidates](size_t index, size_t worker) {
+        TraceSpan span("probe", candidates[index]);
+        Impl::Scratch& s = impl_->scratch[worker];
+        ProbeResult& r = impl_->results[index];
+        r.variable = candidates[index];
+        r.true_implied = impl_->probe_literal(s, triplets, groups, values, r.variable, true, r.true_failed);
+        r.false_implied = impl_->probe_literal(s, triplets, groups, values, r.variable, false, r.false_failed);
+    };
+
+    if (!impl_->pool) {
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            run(i, 0);
+        }
+    } else {
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            impl_->pool->submit([&run, i](size_t worker) { run(i, worker); });
+        }
+        impl_->pool->wait();
+    }
+    return impl_->results;
+}
+
+int Lookahead::best_split(const std::vector<ProbeResult>& results) {
+    int best = 0;
+    size_t best_score = 0;
+    for (const auto& r : results) {
+        if (r.true_failed || r.false_failed) {
+            continue;
+        }
+        // +1 so a polarity that implies nothing does not zero the score
+        size_t score = (r.true_implied + 1) * (r.false_implied + 1);
+        if (best == 0 || score > best_score) {
+            best = r.variable;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+size_t Lookahead::num_threads() const {
+    return impl_->num_threads;
+}
+
+} // namespace stalmarck
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../core/formula.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace stalmarck {
+
+// Outcome of propagating both polarities of one variable
+struct ProbeResult {
+    int variable = 0;
+    size_t true_implied = 0;   // assignments implied by variable = true
+    size_t false_implied = 0;  // assignments implied by variable = false
+    bool true_failed = false;  // variable = true leads to a contradiction
+    bool false_failed = false; // variable = false leads to a contradiction
+};
+
+// Lookahead split selection. Each candidate is probed by propagating both of
+// its polarities on a private copy-on-write view of the current assignment:
+// reads fall through to the shared assignment, writes land in a per-worker
+// overlay that is cleared after the probe. Probes are independent and run in
+// parallel on a thread pool.
+class Lookahead {
+public:
+    explicit Lookahead(size_t num_threads = 1); // 0 = hardware concurrency
+    ~Lookahead();
+
+    Lookahead(const Lookahead&) = delete;
+    Lookahead& operator=(const Lookahead&) = delete;
+
+    // Probe each candidate against values[0..num_values), which must cover
+    // every variable in the triplets. Results are in candidate order.
+    const std::vector<ProbeResult>& probe(const std::vector<std::tuple<int, int, int>>& triplets,
+                                          const TripletKindOffsets* groups,
+                                          const int8_t* values, size_t num_values,
+                                          const std::vector<int>& candidates);
+
+    // The candidate whose two polarities together imply the most, scored by
+    // the product of the implied counts; 0 if every candidate has a failed
+    // polarity
+    static int best_split(const std::vector<ProbeResult>& results);
+
+    size_t num_threads() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace stalmarck
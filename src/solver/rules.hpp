@@ -0,0 +1,226 @@
+#pragma once
+
+#include "../core/formula.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace stalmarck {
+
+// The simple rules of Stalmarck's method over implication triplets, shared by
+// the solver and the lookahead probes. State is any assignment view with
+//   int8_t value(int var)          0 unassigned, 1 true, -1 false
+//   void assign(int var, bool value)
+// A false return means the rules found a contradiction.
+namespace rules {
+
+// Copy-on-write view of an assignment for a tentative propagation: reads fall
+// through to base, writes land in overlay and are listed in touched so the
+// caller can clear them afterwards
+struct OverlayView {
+    const int8_t* base;
+    int8_t* overlay;
+    std::vector<int>* touched;
+
+    int8_t value(int var) const {
+        int8_t local = overlay[var];
+        return local != 0 ? local : base[var];
+    }
+
+    void assign(int var, bool value) {
+        if (overlay[var] == 0) {
+            touched->push_back(var);
+        }
+        overlay[var] = value ? 1 : -1;
+    }
+};
+
+// Propagation kernel for one triplet. The degenerate rules (4 and 7) are
+// compiled in only for the kinds they apply to, so the common kernel has no
+// per-triplet shape tests. Returns false on a contradiction.
+template <bool YEqualsZ, bool XEqualsY, typename State>
+bool apply_rules(State& state, int x, int y, int z, bool& changed) {
+    // Get current assignments (if they exist)
+    int8_t x_raw = state.value(std::abs(x));
+    int8_t y_raw = state.value(std::abs(y));
+    int8_t z_raw = state.value(std::abs(z));
+
+    bool x_assigned = x_raw != 0;
+    bool y_assigned = y_raw != 0;
+    bool z_assigned = z_raw != 0;
+
+    // Get the actual values (accounting for negation). These are literal
+    // values, so a rule that needs a literal true conflicts when its value
+    // is false, whatever the literal's sign
+    bool x_val = x_assigned ? ((x > 0) == (x_raw > 0)) : false;
+    bool y_val = y_assigned ? ((y > 0) == (y_raw > 0)) : false;
+    bool z_val = z_assigned ? ((z > 0) == (z_raw > 0)) : false;
+
+    // Rule 1: (0,y,z) => y=1, z=0
+    if (x_assigned && !x_val) {
+        if (!y_assigned) {
+            state.assign(std::abs(y), (y > 0));
+            changed = true;
+        } else if (!y_val) {
+            return false;
+        }
+
+        if (!z_assigned) {
+            state.assign(std::abs(z), !(z > 0));
+            changed = true;
+        } else if (z_val) {
+            return false;
+        }
+    }
+
+    // Rule 2: (x,0,z) => x=1
+    if (y_assigned && !y_val) {
+        if (!x_assigned) {
+            state.assign(std::abs(x), (x > 0));
+            changed = true;
+        } else if (!x_val) {
+            return false;
+        }
+    }
+
+    // Rule 3: (x,y,0) => x=-y (x is the negation of y)
+    if (z_assigned && !z_val) {
+        if (!x_assigned && !y_assigned) {
+            // Cannot determine values yet
+        } else if (x_assigned && !y_assigned) {
+            state.assign(std::abs(y), !((y > 0) == x_val));
+            changed = true;
+        } else if (!x_assigned && y_assigned) {
+            state.assign(std::abs(x), !((x > 0) == y_val));
+            changed = true;
+        } else if (x_val == y_val) {
+            return false;
+        }
+    }
+
+    // Rule 4: (x,y,y) => x=1
+    if constexpr (YEqualsZ) {
+        if (!x_assigned) {
+            state.assign(std::abs(x), (x > 0));
+            changed = true;
+        } else if (!x_val) {
+            return false;
+        }
+    }
+
+    // Rule 5: (x,y,1) => x=1
+    if (z_assigned && z_val) {
+        if (!x_assigned) {
+            state.assign(std::abs(x), (x > 0));
+            changed = true;
+        } else if (!x_val) {
+            return false;
+        }
+    }
+
+    // Rule 6: (x,1,z) => x=z
+    if (y_assigned && y_val) {
+        if (!x_assigned && !z_assigned) {
+            // Cannot determine values yet
+        } else if (x_assigned && !z_assigned) {
+            state.assign(std::abs(z), ((z > 0) == x_val));
+            changed = true;
+        } else if (!x_assigned && z_assigned) {
+            state.assign(std::abs(x), ((x > 0) == z_val));
+            changed = true;
+        } else if (x_val != z_val) {
+            return false;
+        }
+    }
+
+    // Rule 7: (x,x,z) => x=1, z=1
+    if constexpr (XEqualsY) {
+        if (!x_assigned) {
+            state.assign(std::abs(x), (x > 0));
+            changed = true;
+        } else if (!x_val) {
+            return false;
+        }
+
+        if (!z_assigned) {
+            state.assign(std::abs(z), (z > 0));
+            changed = true;
+        } else if (!z_val) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <bool YEqualsZ, bool XEqualsY, typename State>
+bool sweep(State& state, const std::tuple<int, int, int>* begin, const std::tuple<int, int, int>* end,
+           bool& changed) {
+    for (const auto* t = begin; t != end; ++t) {
+        if (!apply_rules<YEqualsZ, XEqualsY>(state, std::get<0>(*t), std::get<1>(*t), std::get<2>(*t), changed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Triplets not grouped by kind: classify each one as it is visited
+template <typename State>
+bool sweep_unsorted(State& state, const std::vector<std::tuple<int, int, int>>& triplets, bool& changed) {
+    for (const auto& [x, y, z] : triplets) {
+        bool consistent = true;
+        switch (classify_triplet(x, y, z)) {
+            case TripletKind::General: consistent = apply_rules<false, false>(state, x, y, z, changed); break;
+            case TripletKind::XEqualsY: consistent = apply_rules<false, true>(state, x, y, z, changed); break;
+            case TripletKind::YEqualsZ: consistent = apply_rules<true, false>(state, x, y, z, changed); break;
+            case TripletKind::AllEqual: consistent = apply_rules<true, true>(state, x, y, z, changed); break;
+        }
+        if (!consistent) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// One pass over every triplet, group by group when the kind offsets of
+// the list are known
+template <typename State>
+bool sweep_all(State& state, const std::vector<std::tuple<int, int, int>>& triplets,
+               const TripletKindOffsets* groups, bool& changed) {
+    if (groups == nullptr) {
+        return sweep_unsorted(state, triplets, changed);
+    }
+    const auto* base = triplets.data();
+    const TripletKindOffsets& g = *groups;
+    auto group = [&](TripletKind kind) {
+        size_t k = static_cast<size_t>(kind);
+        return std::make_pair(base + g[k], base + g[k + 1]);
+    };
+    auto [general_begin, general_end] = group(TripletKind::General);
+    auto [xy_begin, xy_end] = group(TripletKind::XEqualsY);
+    auto [yz_begin, yz_end] = group(TripletKind::YEqualsZ);
+    auto [all_begin, all_end] = group(TripletKind::AllEqual);
+    return sweep<false, false>(state, general_begin, general_end, changed) &&
+           sweep<false, true>(state, xy_begin, xy_end, changed) &&
+           sweep<true, false>(state, yz_begin, yz_end, changed) &&
+           sweep<true, true>(state, all_begin, all_end, changed);
+}
+
+// Apply the rules until nothing changes
+template <typename State>
+bool saturate(State& state, const std::vector<std::tuple<int, int, int>>& triplets,
+              const TripletKindOffsets* groups) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        if (!sweep_all(state, triplets, groups, changed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace rules
+} // namespace stalmarck
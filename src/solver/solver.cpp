@@ -1,8 +1,22 @@
 #include "solver/solver.hpp"
 #include "core/formula.hpp"
+#include "core/arena.hpp"
+#include "core/trace.hpp"
+#include "solver/rules.hpp"
+#include "solver/lookahead.hpp"
+#include "solver/inprocess.hpp"
+#include "solver/exchange.hpp"
+#include "solver/assignment.hpp"
+#include "solver/gauss.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
+#include <initializer_list>
 #include <sstream>  // For string formatting
 
 namespace stalmarck {
@@ -31,45 +45,442 @@ std::string triplet_to_string(const std::tuple<int, int, int>& triplet) {
 
 class Solver::Impl {
 public:
-    std::unordered_map<int, bool> assignments;
     bool has_contradiction_flag = false;
     bool has_complete_assignment_flag = false;
-    std::vector<std::tuple<int, int, int>> current_triplets;
+    const std::vector<std::tuple<int, int, int>>* current_triplets = nullptr;
+    const TripletKindOffsets* current_groups = nullptr;
     size_t current_num_variables = 0;
+    bool structural = false; // check models against the rules' x <-> (y -> z)
+    const std::vector<XorConstraint>* current_xors = nullptr;
+    std::vector<int> model;
+    SolverStats stats;
+    bool phase_counters = false;
+    PerfCounters* counters = nullptr; // during a solve with phase counters
+
+    // Per-solve state, carved from the arena: values[v] is 0 (unassigned),
+    // 1 (true) or -1 (false); the trail lists assigned variables in order so
+    // branches can be undone without copying the assignment
+    Arena arena;
+    int8_t* values = nullptr;
+    int* trail = nullptr;
+    size_t trail_size = 0;
+    size_t capacity = 0; // number of variable slots, including index 0
+
+    // Compact mode keeps the assignment in packed, two bits per variable,
+    // instead of values; dense is a byte-per-variable copy made on demand
+    // for lookahead and probing
+    bool compact = false;
+    PackedAssignment packed;
+    int8_t* dense = nullptr;
+
+    // Lookahead split selection; off when lookahead_candidates is 0
+    size_t lookahead_candidates = 0;
+    size_t lookahead_threads = 1;
+    std::unique_ptr<Lookahead> lookahead;
+    std::vector<int> candidates;
+
+    // Inprocessing; when on, the solver searches a working copy of the
+    // triplets that simplification rewrites
+    bool inprocessing = false;
+    double inprocess_effort = 0.1; // share of search time spent simplifying
+    double inprocess_seconds = 0.0;
+    uint64_t next_inprocess = 0;   // decision count of the next periodic pass
+    std::chrono::steady_clock::time_point search_start;
+    std::vector<std::tuple<int, int, int>> working_triplets;
+    TripletKindOffsets working_groups{};
+    std::vector<int> representative; // substituted variable -> literal, empty if none
+    std::vector<int> units;
+    std::vector<int> probe_variables; // kept so probing during search does not allocate
+    ProbeScratch probe_scratch;
+
+    // XOR constraints, propagated by elimination; null when there are none
+    std::unique_ptr<GaussElimination> gauss;
+
+    // Fact sharing with other solver threads; off when exchange is null
+    FactExchange* exchange = nullptr;
+    uint16_t exchange_id = 0;
+    size_t max_shared_clause = 3;
+    ExchangeCursor cursor;
+    std::vector<Fact> incoming;
+    std::vector<Fact> imported;             // facts from other threads, as sorted clauses
+    std::vector<uint32_t> imported_index;   // open-addressing set over imported
+    std::vector<int> decisions;             // literals decided on the current path
+    bool unproven_failure = false;          // a branch failed without a contradiction
+    bool has_assumptions = false;
+    bool phase = true;                      // value tried first at each split
+    std::vector<int8_t> phase_hints;        // per variable: 1 true first, -1 false first, 0 phase
+
+    bool first_value(int var) const {
+        size_t index = static_cast<size_t>(var);
+        if (index < phase_hints.size() && phase_hints[index] != 0) {
+            return phase_hints[index] > 0;
+        }
+        return phase;
+    }
+
+    // Timeout handling
+    double timeout = 0.0;
+    std::chrono::steady_clock::time_point deadline;
+    bool interrupted_flag = false;
+    const std::atomic<bool>* stop_flag = nullptr;
+
+    // Progress reporting; off when the callback is empty
+    ProgressCallback progress;
+    double progress_interval = 0.5;
+    std::chrono::steady_clock::time_point solve_start;
+    std::chrono::steady_clock::time_point next_progress;
+
+    void report_progress() {
+        auto now = std::chrono::steady_clock::now();
+        if (now < next_progress) {
+            return;
+        }
+        next_progress = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(progress_interval));
+        SolverProgress snapshot;
+        snapshot.decisions = stats.decisions;
+        snapshot.propagations = stats.propagations;
+        snapshot.trail_depth = trail_size;
+        snapshot.elapsed = std::chrono::duration<double>(now - solve_start).count();
+        progress(snapshot);
+    }
+
+    // True once the time budget is spent or another thread asked to stop
+    bool out_of_time() {
+        if (!interrupted_flag &&
+            ((stop_flag && stop_flag->load(std::memory_order_relaxed)) ||
+             (timeout > 0.0 && std::chrono::steady_clock::now() >= deadline))) {
+            interrupted_flag = true;
+        }
+        return interrupted_flag;
+    }
+
+    // Literal to assign for lit, following substitutions
+    int resolve(int lit) const {
+        int var = std::abs(lit);
+        if (is_substituted(var)) {
+            int rep = representative[var];
+            return resolve(lit > 0 ? rep : -rep);
+        }
+        return lit;
+    }
+
+    // Share a fact derived from the formula alone
+    void publish(FactKind kind, const int* literals, size_t size) {
+        if (exchange == nullptr || has_assumptions || size > MAX_FACT_LITERALS) {
+            return;
+        }
+        Fact fact;
+        fact.kind = kind;
+        fact.size = static_cast<uint8_t>(size);
+        fact.source = exchange_id;
+        std::copy(literals, literals + size, fact.literals.begin());
+        exchange->publish(fact);
+    }
+
+    void publish(FactKind kind, std::initializer_list<int> literals) {
+        publish(kind, literals.begin(), literals.size());
+    }
+
+    // Make room for variables up to max_var, keeping current assignments
+    void ensure_capacity(size_t max_var) {
+        if (max_var < capacity) {
+            return;
+        }
+        size_t new_capacity = std::max(max_var + 1, capacity * 2);
+        if (compact) {
+            uint64_t* words = arena.allocate_zeroed<uint64_t>(PackedAssignment::words_for(new_capacity));
+            if (capacity > 0) {
+                packed.save(words);
+            }
+            packed.attach(words, new_capacity);
+            dense = nullptr;
+        } else {
+            int8_t* new_values = arena.allocate_zeroed<int8_t>(new_capacity);
+            if (capacity > 0) {
+                std::copy(values, values + capacity, new_values);
+            }
+            values = new_values;
+        }
+        int* new_trail = arena.allocate<int>(new_capacity);
+        if (capacity > 0) {
+            std::copy(trail, trail + trail_size, new_trail);
+        }
+        trail = new_trail;
+        capacity = new_capacity;
+    }
+
+    // Assignment access with the storage fixed at compile time
+    template <bool Compact>
+    int8_t load(int var) const {
+        if constexpr (Compact) {
+            return packed.value(var);
+        } else {
+            return values[var];
+        }
+    }
+
+    // Assigning an already assigned variable overwrites it in place
+    template <bool Compact>
+    void store(int var, bool value) {
+        if (load<Compact>(var) == 0) {
+            trail[trail_size++] = var;
+        }
+        if constexpr (Compact) {
+            packed.set(var, value ? 1 : -1);
+        } else {
+            values[var] = value ? 1 : -1;
+        }
+    }
+
+    // View for the rule kernels, so the sweeps carry no storage test
+    template <bool Compact>
+    struct View {
+        Impl& impl;
+        int8_t value(int var) const { return impl.load<Compact>(var); }
+        void assign(int var, bool value) { impl.store<Compact>(var, value); }
+    };
+
+    template <bool Compact>
+    bool sweep(const std::vector<std::tuple<int, int, int>>& triplets,
+               const TripletKindOffsets* groups, bool& changed) {
+        View<Compact> view{*this};
+        return rules::sweep_all(view, triplets, groups, changed);
+    }
+
+    // View for the XOR engine, which sees variables as the formula names
+    // them and so has to follow substitutions
+    struct GaussView {
+        Impl& impl;
+        int8_t value(int var) const { return impl.literal_value(var); }
+        void assign(int var, bool value) {
+            int lit = impl.resolve(value ? var : -var);
+            impl.assign(std::abs(lit), lit > 0);
+            impl.stats.xor_propagations++;
+        }
+    };
+
+    // Set up elimination over the formula's XOR constraints; false if they
+    // are contradictory
+    bool init_xors(const Formula& formula) {
+        current_xors = &formula.get_xors();
+        gauss.reset();
+        if (current_xors->empty()) {
+            return true;
+        }
+        gauss = std::make_unique<GaussElimination>();
+        return gauss->init(*current_xors);
+    }
+
+    bool propagate_xors(bool& changed) {
+        GaussView view{*this};
+        return gauss->propagate(view, changed);
+    }
+
+    // Byte-per-variable assignment, as lookahead and probing take it
+    const int8_t* dense_values() {
+        if (!compact) {
+            return values;
+        }
+        if (dense == nullptr) {
+            dense = arena.allocate<int8_t>(capacity);
+        }
+        packed.unpack(dense, capacity);
+        return dense;
+    }
+
+    bool is_assigned(int var) const {
+        return value(var) != 0;
+    }
+
+    bool is_substituted(int var) const {
+        return static_cast<size_t>(var) < representative.size() && representative[var] != var;
+    }
+
+    // A variable the search still has to decide
+    bool is_free(int var) const {
+        return !is_assigned(var) && !is_substituted(var);
+    }
+
+    // Value of a literal, following substitutions; 0 if unassigned
+    int8_t literal_value(int lit) const {
+        int var = std::abs(lit);
+        if (is_substituted(var)) {
+            int rep = representative[var];
+            return lit > 0 ? literal_value(rep) : -literal_value(rep);
+        }
+        int8_t var_value = value(var);
+        return lit > 0 ? var_value : -var_value;
+    }
+
+    void assign(int var, bool value) {
+        if (compact) {
+            store<true>(var, value);
+        } else {
+            store<false>(var, value);
+        }
+    }
+
+    // Undo every assignment made after the trail had the given size
+    void backtrack(size_t size) {
+        if (compact) {
+            // Unassigning everything is a word fill once the trail is longer
+            if (size == 0 && trail_size > packed.num_words()) {
+                packed.clear();
+                trail_size = 0;
+            }
+            while (trail_size > size) {
+                packed.set(trail[--trail_size], 0);
+            }
+            return;
+        }
+        while (trail_size > size) {
+            values[trail[--trail_size]] = 0;
+        }
+    }
+
+    int8_t value(int var) const {
+        return compact ? load<true>(var) : load<false>(var);
+    }
+
+    // Record the assignment to the problem variables, undoing any reordering
+    void record_model(const Formula& formula) {
+        model.assign(formula.num_variables(), 0);
+        for (size_t var = 1; var <= formula.num_variables(); ++var) {
+            bool value = literal_value(static_cast<int>(var)) > 0;
+            int original = formula.original_variable(static_cast<int>(var));
+            model[original - 1] = value ? original : -original;
+        }
+    }
 };
 
+namespace {
+
+const std::vector<std::tuple<int, int, int>> no_triplets;
+
+// Inprocessing schedule
+constexpr int root_inprocess_rounds = 4;    // simplification rounds before branching
+constexpr uint64_t inprocess_interval = 256; // decisions between periodic passes
+constexpr size_t node_probe_limit = 64;      // variables probed per periodic pass
+
+// Tracing: splits, propagation and sweeps are recorded down to this
+// depth. Below it nodes are too quick and too many to be worth a span;
+// their time shows in their ancestors' spans
+constexpr size_t max_traced_depth = 16;
+
+// Fact sharing
+constexpr size_t max_imported_facts = 10000; // imported clauses kept per solve
+constexpr size_t imported_index_size = 32768; // power of two, under half full
+constexpr uint32_t no_fact = UINT32_MAX;
+constexpr size_t max_polled_facts = 256;      // facts taken in per poll
+
+// Largest variable index referenced by a triplet list
+size_t max_triplet_variable(const std::vector<std::tuple<int, int, int>>& triplets) {
+    int max_var = 0;
+    for (const auto& [x, y, z] : triplets) {
+        max_var = std::max({max_var, std::abs(x), std::abs(y), std::abs(z)});
+    }
+    return static_cast<size_t>(max_var);
+}
+
+} // namespace
+
 Solver::Solver() : impl_(std::make_unique<Impl>()) {}
 Solver::~Solver() = default;
 
 bool Solver::solve(const Formula& formula) {
+    return solve(formula, {});
+}
+
+bool Solver::solve(const Formula& formula, const std::vector<int>& assumptions) {
+    TraceSpan span("solve");
+
     // Reset state at the beginning
     reset();
-    
-    // Check for direct contradictions in unit clauses
-    const auto& clauses = formula.get_clauses(); // You'll need to add this accessor method to your Formula class
-    
-    // Build a set of unit clauses for quick contradiction checking
-    std::unordered_set<int> unit_clauses;
+
+    auto start = std::chrono::steady_clock::now();
+    impl_->solve_start = start;
+    impl_->next_progress = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(impl_->progress_interval));
+    // Counters are per thread, so open them on the solving thread
+    std::unique_ptr<PerfCounters> counters;
+    PhaseCounters before;
+    if (impl_->phase_counters) {
+        counters = std::make_unique<PerfCounters>();
+        impl_->counters = counters.get();
+        before = counters->read();
+        impl_->stats.propagation_phase = phase_difference(before, before); // zero until measured
+    }
+    bool result = search(formula, assumptions);
+    impl_->stats.solve_time = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    if (counters) {
+        PhaseCounters total = phase_difference(counters->read(), before);
+        impl_->stats.search_phase = phase_difference(total, impl_->stats.propagation_phase);
+        impl_->counters = nullptr;
+    }
+    return result;
+}
+
+bool Solver::search(const Formula& formula, const std::vector<int>& assumptions) {
+    const auto& triplets = formula.get_triplets();
+    size_t max_var = std::max(formula.num_variables(), max_triplet_variable(triplets));
+    for (int lit : assumptions) {
+        max_var = std::max(max_var, static_cast<size_t>(std::abs(lit)));
+    }
+    impl_->ensure_capacity(max_var);
+
+    // Check for direct contradictions in unit clauses, marking the polarity
+    // of each unit literal (1 = positive, 2 = negative) in a scratch array
+    const auto& clauses = formula.get_clauses();
+    uint8_t* unit_polarity = impl_->arena.allocate_zeroed<uint8_t>(formula.num_variables() + 1);
     for (const auto& clause : clauses) {
         if (clause.size() == 1) {
             int lit = clause[0];
+            uint8_t polarity = lit < 0 ? 2 : 1;
             // Check if this contradicts an existing unit clause
-            if (unit_clauses.find(-lit) != unit_clauses.end()) {
+            if (unit_polarity[std::abs(lit)] & (3 - polarity)) {
                 impl_->has_contradiction_flag = true;
                 return false;
             }
-            unit_clauses.insert(lit);
+            unit_polarity[std::abs(lit)] |= polarity;
         }
     }
     
-    std::vector<std::tuple<int, int, int>> triplets = formula.get_triplets();
+    // Assumptions hold for this solve only and are fixed before propagation
+    for (int lit : assumptions) {
+        int var = std::abs(lit);
+        if (impl_->is_assigned(var) && (impl_->value(var) > 0) != (lit > 0)) {
+            impl_->has_contradiction_flag = true;
+            return false;
+        }
+        impl_->assign(var, lit > 0);
+    }
     
+    impl_->has_assumptions = !assumptions.empty();
+
     // Store the triplets and formula size for branching
-    impl_->current_triplets = triplets;
+    impl_->current_triplets = &triplets;
+    impl_->current_groups = &formula.get_triplet_kind_offsets();
     impl_->current_num_variables = formula.num_variables();
+    impl_->structural = formula.is_structural();
+
+    // XOR constraints that contradict each other need no search
+    if (!impl_->init_xors(formula)) {
+        impl_->has_contradiction_flag = true;
+        return false;
+    }
     
     // First try simple rules
-    if (!apply_simple_rules(triplets, formula)) {
+    PhaseCounters propagation_start;
+    if (impl_->counters) {
+        propagation_start = impl_->counters->read();
+    }
+    bool consistent = apply_simple_rules(triplets, formula);
+    if (impl_->counters) {
+        impl_->stats.propagation_phase = phase_difference(impl_->counters->read(), propagation_start);
+    }
+    if (!consistent) {
         // A contradiction was detected during simple rule application
         impl_->has_contradiction_flag = true;
         return false;
@@ -77,6 +488,9 @@ bool Solver::solve(const Formula& formula) {
     
     // If we have a complete assignment without contradiction, we're done
     if (has_complete_assignment()) {
+        if (!has_contradiction()) {
+            impl_->record_model(formula);
+        }
         return !has_contradiction();
     }
     
@@ -84,192 +498,179 @@ bool Solver::solve(const Formula& formula) {
     if (has_contradiction()) {
         return false;
     }
+
+    // Simplify the triplets before branching
+    if (impl_->inprocessing && !inprocess_root()) {
+        impl_->has_contradiction_flag = true;
+        return false;
+    }
+    
+    // Facts other threads found so far
+    if (!import_facts()) {
+        impl_->has_contradiction_flag = true;
+        return false;
+    }
     
     // Choose an unassigned variable and try both values
-    for (size_t i = 1; i <= formula.num_variables(); ++i) {
-        if (impl_->assignments.find(i) == impl_->assignments.end()) {
-            // Try p = true
-            if (branch_and_solve(i, true)) {
-                return true;
-            }
-            
-            // Try p = false
-            if (branch_and_solve(i, false)) {
-                return true;
-            }
-            
-            // If both branches lead to contradiction, formula is unsatisfiable
-            impl_->has_contradiction_flag = true;
-            return false;
+    int split = choose_split();
+    if (split < 0) {
+        impl_->has_contradiction_flag = true;
+        return false;
+    }
+    if (split > 0) {
+        // Try p = true (or false first, with the opposite phase or a hint)
+        bool first = impl_->first_value(split);
+        if (branch_and_solve(split, first)) {
+            impl_->record_model(formula);
+            return true;
+        }
+        
+        // Try p = false
+        if (branch_and_solve(split, !first)) {
+            impl_->record_model(formula);
+            return true;
         }
+        
+        // If both branches lead to contradiction, formula is unsatisfiable
+        impl_->has_contradiction_flag = true;
+        return false;
     }
     
     bool result = !has_contradiction();
+    if (result) {
+        impl_->record_model(formula);
+    }
     return result;
 }
 
 bool Solver::apply_simple_rules(const std::vector<std::tuple<int, int, int>>& formula_triplets, const Formula& formula) {
+    impl_->ensure_capacity(std::max(formula.num_variables(), max_triplet_variable(formula_triplets)));
+    // The formula's own triplets are grouped by kind; any other list is
+    // classified as it is swept
+    const TripletKindOffsets* groups = nullptr;
+    if (&formula_triplets == &formula.get_triplets()) {
+        groups = &formula.get_triplet_kind_offsets();
+    }
+    return propagate(formula_triplets, groups, formula.num_variables());
+}
+
+bool Solver::propagate(const std::vector<std::tuple<int, int, int>>& formula_triplets,
+                       const TripletKindOffsets* groups, size_t num_variables) {
+    bool traced = impl_->decisions.size() <= max_traced_depth;
+    TraceSpan span(traced ? "propagate" : nullptr);
+    size_t trail_before = impl_->trail_size;
+    bool consistent = saturate(formula_triplets, groups, num_variables);
+    impl_->stats.propagations += impl_->trail_size - trail_before;
+    if (!consistent) {
+        impl_->stats.conflicts++;
+    }
+    return consistent;
+}
+
+bool Solver::saturate(const std::vector<std::tuple<int, int, int>>& formula_triplets,
+                      const TripletKindOffsets* groups, size_t num_variables) {
     bool changed = true;
+    bool traced = impl_->decisions.size() <= max_traced_depth;
     
     // Keep applying rules until no more changes are made
     while (changed) {
         changed = false;
+        TraceSpan span(traced ? "sweep" : nullptr);
         
         // Iterate through all triplets
-        for (const auto& triplet : formula_triplets) {
-            int x = std::get<0>(triplet);
-            int y = std::get<1>(triplet);
-            int z = std::get<2>(triplet);
-            
-            // Get current assignments (if they exist)
-            auto x_it = impl_->assignments.find(std::abs(x));
-            auto y_it = impl_->assignments.find(std::abs(y));
-            auto z_it = impl_->assignments.find(std::abs(z));
-            
-            bool x_assigned = x_it != impl_->assignments.end();
-            bool y_assigned = y_it != impl_->assignments.end();
-            bool z_assigned = z_it != impl_->assignments.end();
-            
-            // Get the actual values (accounting for negation)
-            bool x_val = x_assigned ? ((x > 0) == x_it->second) : false;
-            bool y_val = y_assigned ? ((y > 0) == y_it->second) : false;
-            bool z_val = z_assigned ? ((z > 0) == z_it->second) : false;
-            
-            // Rule 1: (0,y,z) => y=1, z=0
-            if (x_assigned && !x_val) {
-                if (!y_assigned) {
-                    impl_->assignments[std::abs(y)] = (y > 0);
-                    changed = true;
-                } else if (y_val != (y > 0)) {
-                    impl_->has_contradiction_flag = true;
-                    return false;
-                }
-                
-                if (!z_assigned) {
-                    impl_->assignments[std::abs(z)] = !(z > 0);
-                    changed = true;
-                } else if (z_val == (z > 0)) {
-                    impl_->has_contradiction_flag = true;
-                    return false;
-                }
-            }
-            
-            // Rule 2: (x,0,z) => x=1
-            if (y_assigned && !y_val) {
-                if (!x_assigned) {
-                    impl_->assignments[std::abs(x)] = (x > 0);
-                    changed = true;
-                } else if (x_val != (x > 0)) {
-                    impl_->has_contradiction_flag = true;
-                    return false;
-                }
-            }
-            
-            // Rule 3: (x,y,0) => x=-y (x is the negation of y)
-            if (z_assigned && !z_val) {
-                if (!x_assigned && !y_assigned) {
-                    // Cannot determine values yet
-                } else if (x_assigned && !y_assigned) {
-                    impl_->assignments[std::abs(y)] = !((y > 0) == x_val);
-                    changed = true;
-                } else if (!x_assigned && y_assigned) {
-                    impl_->assignments[std::abs(x)] = !((x > 0) == y_val);
-                    changed = true;
-                } else if (x_val == y_val) {
-                    impl_->has_contradiction_flag = true;
-                    return false;
-                }
-            }
-            
-            // Rule 4: (x,y,y) => x=1
-            if (std::abs(y) == std::abs(z) && 
-                ((y > 0 && z > 0) || (y < 0 && z < 0))) {
-                if (!x_assigned) {
-                    impl_->assignments[std::abs(x)] = (x > 0);
-                    changed = true;
-                } else if (x_val != (x > 0)) {
-                    impl_->has_contradiction_flag = true;
-                    return false;
-                }
-            }
-            
-            // Rule 5: (x,y,1) => x=1
-            if (z_assigned && z_val) {
-                if (!x_assigned) {
-                    impl_->assignments[std::abs(x)] = (x > 0);
-                    changed = true;
-                } else if (x_val != (x > 0)) {
-                    impl_->has_contradiction_flag = true;
-                    return false;
-                }
-            }
-            
-            // Rule 6: (x,1,z) => x=z
-            if (y_assigned && y_val) {
-                if (!x_assigned && !z_assigned) {
-                    // Cannot determine values yet
-                } else if (x_assigned && !z_assigned) {
-                    impl_->assignments[std::abs(z)] = ((z > 0) == x_val);
-                    changed = true;
-                } else if (!x_assigned && z_assigned) {
-                    impl_->assignments[std::abs(x)] = ((x > 0) == z_val);
-                    changed = true;
-                } else if (x_val != z_val) {
-                    impl_->has_contradiction_flag = true;
-                    return false;
-                }
-            }
-            
-            // Rule 7: (x,x,z) => x=1, z=1
-            if (std::abs(x) == std::abs(y) && 
-                ((x > 0 && y > 0) || (x < 0 && y < 0))) {
-                if (!x_assigned) {
-                    impl_->assignments[std::abs(x)] = (x > 0);
-                    changed = true;
-                } else if (x_val != (x > 0)) {
-                    impl_->has_contradiction_flag = true;
-                    return false;
-                }
-                
-                if (!z_assigned) {
-                    impl_->assignments[std::abs(z)] = (z > 0);
-                    changed = true;
-                } else if (z_val != (z > 0)) {
-                    impl_->has_contradiction_flag = true;
-                    return false;
-                }
-            }
+        bool consistent = impl_->compact ? impl_->sweep<true>(formula_triplets, groups, changed)
+                                         : impl_->sweep<false>(formula_triplets, groups, changed);
+        if (consistent && impl_->gauss) {
+            consistent = impl_->propagate_xors(changed);
         }
-        
-        // Check if we now have a complete assignment
-        if (impl_->assignments.size() == formula.num_variables()) {
-            impl_->has_complete_assignment_flag = true;
-            return true;
+        if (!consistent) {
+            impl_->has_contradiction_flag = true;
+            return false;
         }
     }
+
+    // Complete only at the fixpoint: the last sweep saw every triplet with
+    // the final values, so none of them is violated
+    if (impl_->trail_size == num_variables) {
+        impl_->has_complete_assignment_flag = true;
+        return true;
+    }
     
     return !impl_->has_contradiction_flag;
 }
 
 bool Solver::branch_and_solve(int variable, bool value) {
-    // Save the current state before branching
-    auto saved_assignments = impl_->assignments;
+    int decision = value ? variable : -variable;
+    TraceSpan span(impl_->decisions.size() < max_traced_depth ? "split" : nullptr, decision);
+    impl_->decisions.push_back(decision);
+    bool outer_unproven = impl_->unproven_failure;
+    impl_->unproven_failure = false;
+    bool result = branch(variable, value);
+    impl_->decisions.pop_back();
+    bool refuted = !result && !impl_->unproven_failure;
+    impl_->unproven_failure |= outer_unproven;
+
+    // A branch refuted by contradictions alone yields the clause "not all
+    // of these decisions"; share it when it is short
+    if (refuted && !impl_->interrupted_flag && impl_->exchange != nullptr &&
+        impl_->decisions.size() < impl_->max_shared_clause) {
+        std::array<int, MAX_FACT_LITERALS> clause;
+        size_t size = 0;
+        for (int lit : impl_->decisions) {
+            clause[size++] = -lit;
+        }
+        clause[size++] = -decision;
+        impl_->publish(size == 1 ? FactKind::Unit : FactKind::Clause, clause.data(), size);
+    }
+    return result;
+}
+
+bool Solver::branch(int variable, bool value) {
+    // Give up on this branch once the time budget is spent
+    if (impl_->out_of_time()) {
+        impl_->unproven_failure = true;
+        return false;
+    }
+
+    impl_->ensure_capacity(static_cast<size_t>(variable));
+    impl_->stats.decisions++;
+    if (impl_->progress) {
+        impl_->report_progress();
+    }
+
+    // Save the current state before branching; the trail size is enough to
+    // undo every assignment made below this point
+    size_t saved_trail = impl_->trail_size;
     bool saved_contradiction = impl_->has_contradiction_flag;
     bool saved_complete_assignment = impl_->has_complete_assignment_flag;
+    auto restore = [&]() {
+        impl_->backtrack(saved_trail);
+        impl_->has_contradiction_flag = saved_contradiction;
+        impl_->has_complete_assignment_flag = saved_complete_assignment;
+    };
     
     // Set the variable to the given value
-    impl_->assignments[variable] = value;
-    
-    // Create a temporary formula to pass to apply_simple_rules
-    Formula temp_formula;
+    impl_->assign(variable, value);
     
-    // Apply simple rules with the new assignment
-    if (!apply_simple_rules(impl_->current_triplets, temp_formula)) {
+    // Apply simple rules with the new assignment. Branches never count as
+    // complete inside propagation; completeness is checked below
+    const auto& triplets = impl_->current_triplets ? *impl_->current_triplets : no_triplets;
+    if (!propagate(triplets, impl_->current_groups, 0)) {
         // This branch leads to a contradiction
         // Restore the state before returning
-        impl_->assignments = saved_assignments;
-        impl_->has_contradiction_flag = saved_contradiction;
-        impl_->has_complete_assignment_flag = saved_complete_assignment;
+        restore();
+        return false;
+    }
+    
+    // Periodic failed-literal probing within the effort budget
+    if (impl_->inprocessing && impl_->stats.decisions >= impl_->next_inprocess && !inprocess_node()) {
+        restore();
+        return false;
+    }
+
+    // Propagation is at a fixpoint: a safe point to take in shared facts
+    if (!import_facts()) {
+        restore();
         return false;
     }
     
@@ -280,62 +681,374 @@ bool Solver::branch_and_solve(int variable, bool value) {
         if (satisfies) {
             return true;
         } else {
-            impl_->has_contradiction_flag = true;
-            impl_->assignments = saved_assignments;
-            impl_->has_contradiction_flag = saved_contradiction;
-            impl_->has_complete_assignment_flag = saved_complete_assignment;
+            // Not a refutation: nothing contradicts these decisions
+            impl_->unproven_failure = true;
+            restore();
             return false;
         }
     }
     
     // Need to continue branching on other variables
-    for (size_t i = 1; i <= impl_->current_num_variables; ++i) {
-        if (i != variable && impl_->assignments.find(i) == impl_->assignments.end()) {
-            // Try TRUE branch
-            bool true_branch = branch_and_solve(i, true);
-            if (true_branch) {
-                return true;
-            }
-            
-            // Try FALSE branch 
-            bool false_branch = branch_and_solve(i, false);
-            if (false_branch) {
-                return true;
-            }
-            
-            // If both branches failed, this path is unsatisfiable
-            impl_->has_contradiction_flag = true;
-            // Restore state before returning
-            impl_->assignments = saved_assignments;
-            impl_->has_contradiction_flag = saved_contradiction;
-            impl_->has_complete_assignment_flag = saved_complete_assignment;
-            return false;
+    int split = choose_split();
+    if (split < 0) {
+        impl_->unproven_failure = true;
+        restore();
+        return false;
+    }
+    if (split > 0) {
+        // Try the preferred value first
+        bool first = impl_->first_value(split);
+        bool true_branch = branch_and_solve(split, first);
+        if (true_branch) {
+            return true;
         }
+        
+        // Then the other one
+        bool false_branch = branch_and_solve(split, !first);
+        if (false_branch) {
+            return true;
+        }
+        
+        // If both branches failed, this path is unsatisfiable
+        restore();
+        return false;
     }
     
     // If no unassigned variables found and we get here, we have a complete assignment
-    if (impl_->assignments.size() >= impl_->current_num_variables && !has_contradiction()) {
+    if (impl_->trail_size >= impl_->current_num_variables && !has_contradiction()) {
         // Verify this assignment actually satisfies the formula
         bool satisfies = verify_assignment();
         if (satisfies) {
             impl_->has_complete_assignment_flag = true;
             return true;
         } else {
-            impl_->has_contradiction_flag = true;
-            impl_->assignments = saved_assignments;
-            impl_->has_contradiction_flag = saved_contradiction;
-            impl_->has_complete_assignment_flag = saved_complete_assignment;
+            impl_->unproven_failure = true;
+            restore();
             return false;
         }
     }
     
     // Otherwise, restore state and return false
-    impl_->assignments = saved_assignments;
-    impl_->has_contradiction_flag = saved_contradiction;
-    impl_->has_complete_assignment_flag = saved_complete_assignment;
+    impl_->unproven_failure = true;
+    restore();
     return false;
 }
 
+bool Solver::assign_units(const std::vector<int>& units) {
+    for (int lit : units) {
+        int var = std::abs(lit);
+        if (!impl_->is_assigned(var)) {
+            impl_->assign(var, lit > 0);
+            impl_->stats.failed_literals++;
+        } else if ((impl_->value(var) > 0) != (lit > 0)) {
+            return false;
+        }
+    }
+    return propagate(*impl_->current_triplets, impl_->current_groups, 0);
+}
+
+bool Solver::import_facts() {
+    if (impl_->exchange == nullptr) {
+        return true;
+    }
+
+    // Take in new facts from other threads as clauses, skipping our own,
+    // over-long clauses and ones already held. The clauses and the set of
+    // them are preallocated by set_exchange, so the search does not allocate
+    impl_->incoming.clear();
+    impl_->exchange->poll(impl_->cursor, impl_->incoming, max_polled_facts);
+    auto keep = [this](const int* literals, size_t size) {
+        if (impl_->imported.size() >= max_imported_facts) {
+            return;
+        }
+        Fact clause;
+        clause.kind = FactKind::Clause;
+        clause.size = static_cast<uint8_t>(size);
+        uint64_t hash = size;
+        for (size_t i = 0; i < size; ++i) {
+            if (literals[i] == 0 || static_cast<size_t>(std::abs(literals[i])) >= impl_->capacity) {
+                return;
+            }
+            clause.literals[i] = literals[i];
+        }
+        auto begin = clause.literals.begin();
+        std::sort(begin, begin + size);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<uint32_t>(clause.literals[i])) * 0x100000001B3ULL;
+        }
+        for (size_t slot = hash & (imported_index_size - 1);; slot = (slot + 1) & (imported_index_size - 1)) {
+            uint32_t index = impl_->imported_index[slot];
+            if (index == no_fact) {
+                impl_->imported_index[slot] = static_cast<uint32_t>(impl_->imported.size());
+                impl_->imported.push_back(clause);
+                return;
+            }
+            const Fact& held = impl_->imported[index];
+            if (held.size == size && std::equal(begin, begin + size, held.literals.begin())) {
+                return;
+            }
+        }
+    };
+    for (const Fact& fact : impl_->incoming) {
+        if (fact.source == impl_->exchange_id) {
+            continue;
+        }
+        const auto& lits = fact.literals;
+        switch (fact.kind) {
+            case FactKind::Unit:
+                keep(lits.data(), 1);
+                break;
+            case FactKind::Equivalence: {
+                int forward[2] = {-lits[0], lits[1]};
+                int backward[2] = {lits[0], -lits[1]};
+                keep(forward, 2);
+                keep(backward, 2);
+                break;
+            }
+            case FactKind::Clause:
+                if (fact.size <= impl_->max_shared_clause) {
+                    keep(lits.data(), fact.size);
+                }
+                break;
+        }
+    }
+
+    // Unit-propagate the imported clauses together with the triplets
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const Fact& clause : impl_->imported) {
+            int unassigned = 0;
+            size_t open = 0;
+            bool satisfied = false;
+            for (size_t i = 0; i < clause.size; ++i) {
+                int lit = clause.literals[i];
+                int8_t value = impl_->literal_value(lit);
+                if (value > 0) {
+                    satisfied = true;
+                    break;
+                }
+                if (value == 0) {
+                    unassigned = lit;
+                    open++;
+                }
+            }
+            if (satisfied || open > 1) {
+                continue;
+            }
+            if (open == 0) {
+                impl_->has_contradiction_flag = true;
+                return false;
+            }
+            int lit = impl_->resolve(unassigned);
+            impl_->assign(std::abs(lit), lit > 0);
+            changed = true;
+        }
+        if (changed && !propagate(*impl_->current_triplets, impl_->current_groups, 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Solver::inprocess_root() {
+    TraceSpan span("inprocess");
+    auto start = std::chrono::steady_clock::now();
+    impl_->search_start = start;
+    impl_->working_triplets = *impl_->current_triplets;
+    impl_->working_groups = group_triplets_by_kind(impl_->working_triplets);
+    impl_->current_triplets = &impl_->working_triplets;
+    impl_->current_groups = &impl_->working_groups;
+
+    size_t max_var = impl_->capacity - 1;
+    impl_->representative.resize(max_var + 1);
+    for (size_t var = 0; var <= max_var; ++var) {
+        impl_->representative[var] = static_cast<int>(var);
+    }
+
+    bool consistent = true;
+    std::vector<int> found;
+    std::vector<int>& variables = impl_->probe_variables;
+    for (int round = 0; round < root_inprocess_rounds && consistent; ++round) {
+        // Equivalent literals: substitute them out of the working triplets
+        if (!find_equivalent_literals(impl_->working_triplets, max_var, found)) {
+            consistent = false;
+            break;
+        }
+        size_t substituted = substitute_equivalent_literals(impl_->working_triplets, found);
+        impl_->units.clear();
+        if (substituted > 0) {
+            impl_->working_groups = group_triplets_by_kind(impl_->working_triplets);
+            impl_->stats.substituted_variables += substituted;
+            for (size_t var = 1; var <= max_var; ++var) {
+                int& rep = impl_->representative[var];
+                rep = rep > 0 ? found[rep] : -found[-rep];
+                // An assigned variable passes its value to its representative
+                if (rep != static_cast<int>(var) && impl_->is_assigned(static_cast<int>(var))) {
+                    impl_->units.push_back(impl_->value(var) > 0 ? rep : -rep);
+                }
+                if (found[var] != static_cast<int>(var)) {
+                    impl_->publish(FactKind::Equivalence, {static_cast<int>(var), found[var]});
+                }
+            }
+        }
+
+        // Failed literals and literals implied by both polarities
+        variables.clear();
+        for (size_t var = 1; var <= impl_->current_num_variables; ++var) {
+            if (impl_->is_free(static_cast<int>(var))) {
+                variables.push_back(static_cast<int>(var));
+            }
+        }
+        if (!probe_failed_literals(impl_->working_triplets, &impl_->working_groups, impl_->dense_values(),
+                                   impl_->capacity, variables, variables.size(), impl_->units,
+                                   impl_->probe_scratch)) {
+            consistent = false;
+            break;
+        }
+        if (substituted == 0 && impl_->units.empty()) {
+            break;
+        }
+        for (int lit : impl_->units) {
+            impl_->publish(FactKind::Unit, {lit});
+        }
+        consistent = assign_units(impl_->units);
+    }
+
+    impl_->inprocess_seconds += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    impl_->next_inprocess = impl_->stats.decisions + inprocess_interval;
+    return consistent;
+}
+
+bool Solver::inprocess_node() {
+    TraceSpan span("inprocess");
+    auto start = std::chrono::steady_clock::now();
+    impl_->next_inprocess = impl_->stats.decisions + inprocess_interval;
+
+    // Stay within the configured share of the search time so far
+    double searched = std::chrono::duration<double>(start - impl_->search_start).count();
+    if (impl_->inprocess_seconds > impl_->inprocess_effort * searched) {
+        return true;
+    }
+
+    std::vector<int>& variables = impl_->probe_variables;
+    variables.clear();
+    for (size_t var = 1; var <= impl_->current_num_variables && variables.size() < node_probe_limit; ++var) {
+        if (impl_->is_free(static_cast<int>(var))) {
+            variables.push_back(static_cast<int>(var));
+        }
+    }
+    impl_->units.clear();
+    bool consistent = probe_failed_literals(*impl_->current_triplets, impl_->current_groups,
+                                            impl_->dense_values(), impl_->capacity, variables, variables.size(), impl_->units,
+                                            impl_->probe_scratch) &&
+                      assign_units(impl_->units);
+
+    impl_->inprocess_seconds += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return consistent;
+}
+
+int Solver::choose_split() {
+    size_t num_variables = impl_->current_num_variables;
+    if (impl_->lookahead_candidates == 0 || impl_->current_triplets == nullptr) {
+        for (size_t i = 1; i <= num_variables; ++i) {
+            if (impl_->is_free(i)) {
+                return static_cast<int>(i);
+            }
+        }
+        return 0;
+    }
+
+    if (!impl_->lookahead || impl_->lookahead->num_threads() != impl_->lookahead_threads) {
+        impl_->lookahead = std::make_unique<Lookahead>(impl_->lookahead_threads);
+    }
+
+    // Probe until no candidate has a failed polarity; each round fixes at
+    // least one variable, so this terminates
+    while (true) {
+        impl_->candidates.clear();
+        for (size_t i = 1; i <= num_variables && impl_->candidates.size() < impl_->lookahead_candidates; ++i) {
+            if (impl_->is_free(i)) {
+                impl_->candidates.push_back(static_cast<int>(i));
+            }
+        }
+        if (impl_->candidates.empty()) {
+            return 0;
+        }
+
+        TraceSpan span("lookahead");
+        const auto& results = impl_->lookahead->probe(*impl_->current_triplets, impl_->current_groups,
+                                                      impl_->dense_values(), impl_->capacity,
+                                                      impl_->candidates);
+
+        // A failed literal forces the opposite polarity; both failing
+        // refutes the current node
+        bool forced = false;
+        for (const auto& r : results) {
+            if (r.true_failed && r.false_failed) {
+                return -1;
+            }
+            if (r.true_failed || r.false_failed) {
+                impl_->assign(r.variable, r.true_failed ? false : true);
+                impl_->stats.failed_literals++;
+                forced = true;
+            }
+        }
+        if (!forced) {
+            int best = Lookahead::best_split(results);
+            return best != 0 ? best : impl_->candidates.front();
+        }
+        if (!propagate(*impl_->current_triplets, impl_->current_groups, 0)) {
+            return -1;
+        }
+    }
+}
+
+void Solver::make_cubes(const Formula& formula, size_t depth, std::vector<std::vector<int>>& cubes) {
+    reset();
+    cubes.clear();
+
+    const auto& triplets = formula.get_triplets();
+    impl_->current_triplets = &triplets;
+    impl_->current_groups = &formula.get_triplet_kind_offsets();
+    impl_->current_num_variables = formula.num_variables();
+    impl_->structural = formula.is_structural();
+
+    if (!impl_->init_xors(formula)) {
+        return;
+    }
+    if (!apply_simple_rules(triplets, formula)) {
+        return;
+    }
+
+    std::vector<int> cube;
+    split_cubes(depth, cube, cubes);
+}
+
+void Solver::split_cubes(size_t depth, std::vector<int>& cube, std::vector<std::vector<int>>& cubes) {
+    size_t saved_trail = impl_->trail_size;
+    int split = depth > 0 ? choose_split() : 0;
+    if (split == 0) {
+        cubes.push_back(cube);
+    } else if (split > 0) {
+        for (bool value : {true, false}) {
+            size_t branch_trail = impl_->trail_size;
+            impl_->assign(split, value);
+            if (propagate(*impl_->current_triplets, impl_->current_groups, 0)) {
+                cube.push_back(value ? split : -split);
+                split_cubes(depth - 1, cube, cubes);
+                cube.pop_back();
+            }
+            impl_->backtrack(branch_trail);
+            impl_->has_contradiction_flag = false;
+        }
+    }
+    impl_->backtrack(saved_trail);
+    impl_->has_contradiction_flag = false;
+}
+
 bool Solver::has_contradiction() const {
     return impl_->has_contradiction_flag;
 }
@@ -345,14 +1058,119 @@ bool Solver::has_complete_assignment() const {
 }
 
 void Solver::reset() {
-    impl_->assignments.clear();
+    // Release all per-solve state at once; the arena keeps its memory
+    impl_->arena.reset();
+    impl_->values = nullptr;
+    impl_->packed.attach(nullptr, 0);
+    impl_->dense = nullptr;
+    impl_->trail = nullptr;
+    impl_->trail_size = 0;
+    impl_->capacity = 0;
+    impl_->current_triplets = nullptr;
+    impl_->current_groups = nullptr;
+    impl_->current_xors = nullptr;
+    impl_->gauss.reset();
+    impl_->working_triplets.clear();
+    impl_->representative.clear();
+    impl_->inprocess_seconds = 0.0;
+    impl_->next_inprocess = 0;
+    impl_->imported.clear();
+    std::fill(impl_->imported_index.begin(), impl_->imported_index.end(), no_fact);
+    impl_->unproven_failure = false;
+    impl_->decisions.clear();
     impl_->has_contradiction_flag = false;
     impl_->has_complete_assignment_flag = false;
+    impl_->model.clear();
+    impl_->stats = SolverStats{};
+    impl_->interrupted_flag = false;
+    if (impl_->timeout > 0.0) {
+        impl_->deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(impl_->timeout));
+    }
+}
+
+void Solver::set_timeout(double seconds) {
+    impl_->timeout = seconds;
+}
+
+void Solver::set_inprocessing(bool enabled, double effort) {
+    impl_->inprocessing = enabled;
+    impl_->inprocess_effort = effort;
+}
+
+void Solver::set_exchange(FactExchange* exchange, uint16_t id, size_t max_clause_size) {
+    impl_->exchange = exchange;
+    impl_->exchange_id = id;
+    impl_->max_shared_clause = std::min(max_clause_size, MAX_FACT_LITERALS);
+    impl_->cursor = ExchangeCursor{};
+    if (exchange != nullptr) {
+        impl_->incoming.reserve(max_polled_facts);
+        impl_->imported.reserve(max_imported_facts);
+        impl_->imported_index.assign(imported_index_size, no_fact);
+    }
+}
+
+void Solver::set_compact(bool enabled) {
+    impl_->compact = enabled;
+}
+
+void Solver::set_phase(bool first_value) {
+    impl_->phase = first_value;
+}
+
+void Solver::set_phase_hints(const std::vector<int>& literals) {
+    impl_->phase_hints.clear();
+    for (int lit : literals) {
+        size_t var = static_cast<size_t>(std::abs(lit));
+        if (var >= impl_->phase_hints.size()) {
+            impl_->phase_hints.resize(var + 1, 0);
+        }
+        impl_->phase_hints[var] = lit > 0 ? 1 : -1;
+    }
+}
+
+void Solver::set_stop_flag(const std::atomic<bool>* stop) {
+    impl_->stop_flag = stop;
+}
+
+void Solver::set_phase_counters(bool enabled) {
+    impl_->phase_counters = enabled;
+}
+
+void Solver::set_progress_callback(ProgressCallback callback, double interval) {
+    impl_->progress = std::move(callback);
+    impl_->progress_interval = interval;
+}
+
+void Solver::set_lookahead(size_t candidates, size_t threads) {
+    impl_->lookahead_candidates = candidates;
+    impl_->lookahead_threads = threads;
+}
+
+bool Solver::is_interrupted() const {
+    return impl_->interrupted_flag;
+}
+
+const std::vector<int>& Solver::get_model() const {
+    return impl_->model;
+}
+
+const SolverStats& Solver::get_stats() const {
+    return impl_->stats;
+}
+
+size_t Solver::arena_capacity() const {
+    return impl_->arena.capacity();
 }
 
 bool Solver::verify_assignment() {
+    if (impl_->current_triplets == nullptr) {
+        return true;
+    }
+
     // Check each triplet to ensure it's satisfied
-    for (const auto& triplet : impl_->current_triplets) {
+    for (const auto& triplet : *impl_->current_triplets) {
         int x = std::get<0>(triplet);
         int y = std::get<1>(triplet);
         int z = std::get<2>(triplet);
@@ -362,24 +1180,39 @@ bool Solver::verify_assignment() {
         bool y_val = eval_literal(y);
         bool z_val = eval_literal(z);
         
-        // A triplet encodes (x ↔ (y ∧ z)), which is satisfied if x = (y && z)
-        bool triplet_satisfied = (x_val == (y_val && z_val));
+        // A clause triplet is checked as (x ↔ (y ∧ z)), which is satisfied if
+        // x = (y && z); structural triplets mean (x ↔ (y → z)), as in the rules
+        bool triplet_satisfied = impl_->structural ? (x_val == (!y_val || z_val))
+                                                   : (x_val == (y_val && z_val));
         
         if (!triplet_satisfied) {
             return false;
         }
     }
+
+    if (impl_->current_xors != nullptr) {
+        for (const auto& constraint : *impl_->current_xors) {
+            bool parity = false;
+            for (int var : constraint.variables) {
+                parity ^= impl_->literal_value(var) > 0;
+            }
+            if (parity != constraint.rhs) {
+                return false;
+            }
+        }
+    }
     
     return true;
 }
 
 bool Solver::eval_literal(int literal) {
-    // Get the variable's assignment, respecting the sign
+    // Get the variable's assignment, respecting the sign; unassigned
+    // variables read as false
     int var = std::abs(literal);
-    bool var_value = impl_->assignments[var];
+    bool var_value = static_cast<size_t>(var) < impl_->capacity && impl_->value(var) > 0;
     
     // If the literal is negative, negate the value
     return (literal > 0) ? var_value : !var_value;
 }
 
-} // namespace stalmarck
\ No newline at end of file
+} // namespace stalmarck
@@ -1,11 +1,43 @@
 #pragma once
 
 #include "../core/formula.hpp"
+#include "../core/perf_counters.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <memory>
 
 namespace stalmarck {
 
+class FactExchange;
+
+// Search counters for the last solve
+struct SolverStats {
+    uint64_t decisions = 0;              // branches taken
+    uint64_t propagations = 0;           // assignments derived by the simple rules
+    uint64_t conflicts = 0;              // contradictions found by the simple rules
+    uint64_t failed_literals = 0;        // literals fixed by probing
+    uint64_t substituted_variables = 0;  // replaced by an equivalent literal
+    uint64_t xor_propagations = 0;       // assignments forced by XOR constraints
+    double solve_time = 0.0;             // seconds
+
+    // With set_phase_counters: the root propagation of apply_simple_rules,
+    // and the rest of the solve
+    PhaseCounters propagation_phase;
+    PhaseCounters search_phase;
+};
+
+// Snapshot of a running search, passed to the progress callback
+struct SolverProgress {
+    uint64_t decisions = 0;
+    uint64_t propagations = 0;
+    size_t trail_depth = 0;  // variables currently assigned
+    double elapsed = 0.0;    // seconds since the solve started
+};
+
+using ProgressCallback = std::function<void(const SolverProgress&)>;
+
 class Solver {
 public:
     Solver();
@@ -13,6 +45,7 @@ public:
 
     // Core algorithm methods
     bool solve(const Formula& formula);
+    bool solve(const Formula& formula, const std::vector<int>& assumptions);
     bool apply_simple_rules(const std::vector<std::tuple<int, int, int>>& formula_triplets, const Formula& formula);
     bool branch_and_solve(int variable, bool value);
     
@@ -23,7 +56,84 @@ public:
     bool eval_literal(int literal);
     void reset();
 
+    // Resource limits
+    void set_timeout(double seconds);
+    bool is_interrupted() const;
+
+    // Pick each split by probing up to `candidates` unassigned variables on
+    // `threads` threads (0 = hardware concurrency); 0 candidates branches on
+    // the first unassigned variable
+    void set_lookahead(size_t candidates, size_t threads = 1);
+
+    // Simplify the triplets during search: equivalent-literal substitution
+    // and failed-literal probing before branching, then periodic probing
+    // limited to `effort` times the search time so far
+    void set_inprocessing(bool enabled, double effort = 0.1);
+
+    // Memory-bounded mode: keep the assignment at two bits per variable
+    // instead of a byte, for formulas with very many auxiliary variables.
+    // Propagation is a little slower; takes effect at the next solve.
+    void set_compact(bool enabled);
+
+    // Parallel solving. Share units, equivalences and refuted decision
+    // paths of up to max_clause_size literals with other solvers of the same
+    // formula through exchange, and import theirs at safe points (nullptr
+    // turns sharing off). id tells this solver's facts apart.
+    void set_exchange(FactExchange* exchange, uint16_t id, size_t max_clause_size = 3);
+    void set_phase(bool first_value);                // value tried first at each split
+
+    // Try each hinted literal's value first when splitting on its variable,
+    // e.g. from a local search's best assignment; other variables follow
+    // set_phase. Literals are in the formula's numbering; empty clears them
+    void set_phase_hints(const std::vector<int>& literals);
+    void set_stop_flag(const std::atomic<bool>* stop); // interrupt once it is set
+
+    // Measure time and hardware counters of the solve phases into the stats
+    void set_phase_counters(bool enabled);
+
+    // Call back from the solving thread at most every interval seconds,
+    // checked at each decision; an empty callback turns it off
+    void set_progress_callback(ProgressCallback callback, double interval = 0.5);
+
+    // Split the formula into assumption cubes for cube-and-conquer: branch
+    // `depth` levels deep, choosing splits as solve() would (use lookahead
+    // for good cubes) and dropping branches propagation refutes. The cubes
+    // cover every assignment not refuted; none means the formula is UNSAT.
+    void make_cubes(const Formula& formula, size_t depth, std::vector<std::vector<int>>& cubes);
+
+    // Satisfying assignment from the last solve, in the formula's original
+    // variable numbering: entry i is +(i+1) or -(i+1)
+    const std::vector<int>& get_model() const;
+
+    const SolverStats& get_stats() const;
+
+    // Bytes retained by the per-solve arena; persists across solves
+    size_t arena_capacity() const;
+
 private:
+    bool search(const Formula& formula, const std::vector<int>& assumptions);
+
+    // Next variable to branch on; 0 when all are assigned, -1 when lookahead
+    // refutes the current node
+    int choose_split();
+
+    // Inprocessing passes; false when they refute the current node
+    bool inprocess_root();
+    bool inprocess_node();
+    bool assign_units(const std::vector<int>& units);
+    bool import_facts();
+    bool branch(int variable, bool value);
+
+    void split_cubes(size_t depth, std::vector<int>& cube, std::vector<std::vector<int>>& cubes);
+
+    // Rule saturation over the given triplets; a complete assignment is
+    // reported once num_variables variables are assigned. groups gives the
+    // kind boundaries of the list, or nullptr if it is not grouped
+    bool propagate(const std::vector<std::tuple<int, int, int>>& formula_triplets,
+                   const TripletKindOffsets* groups, size_t num_variables);
+    bool saturate(const std::vector<std::tuple<int, int, int>>& formula_triplets,
+                  const TripletKindOffsets* groups, size_t num_variables);
+
     class Impl;
     std::unique_ptr<Impl> impl_;
 };
@@ -0,0 +1,380 @@
+#include "solver/symmetry.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <set>
+
+namespace stalmarck {
+
+namespace {
+
+// Colored clause-literal graph in CSR form. Vertex 2(v-1) is literal v and
+// 2(v-1)+1 is -v, each joined to its negation; clause vertices follow,
+// joined to their literals.
+struct Graph {
+    size_t num_literal_vertices = 0;
+    std::vector<int> offsets;
+    std::vector<int> adjacency;
+
+    size_t size() const { return offsets.size() - 1; }
+    size_t degree(int v) const { return offsets[v + 1] - offsets[v]; }
+};
+
+int literal_vertex(int lit) {
+    return lit > 0 ? 2 * (lit - 1) : 2 * (-lit - 1) + 1;
+}
+
+int vertex_literal(int vertex) {
+    int var = vertex / 2 + 1;
+    return vertex % 2 == 0 ? var : -var;
+}
+
+Graph build_graph(const std::vector<std::vector<int>>& clauses, size_t num_vars) {
+    Graph g;
+    g.num_literal_vertices = 2 * num_vars;
+    size_t num_vertices = g.num_literal_vertices + clauses.size();
+
+    std::vector<std::vector<int>> neighbours(num_vertices);
+    for (size_t v = 0; v < num_vars; ++v) {
+        neighbours[2 * v].push_back(static_cast<int>(2 * v + 1));
+        neighbours[2 * v + 1].push_back(static_cast<int>(2 * v));
+    }
+    std::vector<int> literals;
+    for (size_t c = 0; c < clauses.size(); ++c) {
+        int clause_vertex = static_cast<int>(g.num_literal_vertices + c);
+        literals.assign(clauses[c].begin(), clauses[c].end());
+        std::sort(literals.begin(), literals.end());
+        literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+        for (int lit : literals) {
+            neighbours[clause_vertex].push_back(literal_vertex(lit));
+            neighbours[literal_vertex(lit)].push_back(clause_vertex);
+        }
+    }
+
+    g.offsets.assign(num_vertices + 1, 0);
+    for (size_t v = 0; v < num_vertices; ++v) {
+        g.offsets[v + 1] = g.offsets[v] + static_cast<int>(neighbours[v].size());
+    }
+    g.adjacency.reserve(g.offsets.back());
+    for (const auto& list : neighbours) {
+        g.adjacency.insert(g.adjacency.end(), list.begin(), list.end());
+    }
+    return g;
+}
+
+// Colour refinement to the coarsest equitable partition. Colours are
+// renumbered 0..k-1 in the order of (old colour, multiset of neighbour
+// colours), which depends on the graph's structure only, so refining two
+// partitions related by an automorphism gives colourings related by it too.
+class Refiner {
+public:
+    explicit Refiner(const Graph& g) : g_(g), signature_(g.adjacency.size()), order_(g.size()) {}
+
+    // Returns the number of colours
+    size_t refine(std::vector<int>& colors) {
+        size_t cells = count(colors);
+        while (true) {
+            for (size_t v = 0; v < g_.size(); ++v) {
+                for (int i = g_.offsets[v]; i < g_.offsets[v + 1]; ++i) {
+                    signature_[i] = colors[g_.adjacency[i]];
+                }
+                std::sort(signature_.begin() + g_.offsets[v], signature_.begin() + g_.offsets[v + 1]);
+            }
+            std::iota(order_.begin(), order_.end(), 0);
+            auto less = [&](int a, int b) {
+                if (colors[a] != colors[b]) {
+                    return colors[a] < colors[b];
+                }
+                return std::lexicographical_compare(
+                    signature_.begin() + g_.offsets[a], signature_.begin() + g_.offsets[a + 1],
+                    signature_.begin() + g_.offsets[b], signature_.begin() + g_.offsets[b + 1]);
+            };
+            std::sort(order_.begin(), order_.end(), less);
+
+            std::vector<int>& refined = scratch_;
+            refined.resize(colors.size());
+            int color = 0;
+            for (size_t i = 0; i < order_.size(); ++i) {
+                if (i > 0 && less(order_[i - 1], order_[i])) {
+                    color++;
+                }
+                refined[order_[i]] = color;
+            }
+            colors.swap(refined);
+            size_t refined_cells = static_cast<size_t>(color) + 1;
+            if (refined_cells == cells) {
+                return cells;
+            }
+            cells = refined_cells;
+        }
+    }
+
+private:
+    static size_t count(const std::vector<int>& colors) {
+        return colors.empty() ? 0 : static_cast<size_t>(*std::max_element(colors.begin(), colors.end())) + 1;
+    }
+
+    const Graph& g_;
+    std::vector<int> signature_;
+    std::vector<int> order_;
+    std::vector<int> scratch_;
+};
+
+// Give vertex x a colour of its own, just before the rest of its cell
+std::vector<int> individualize(const std::vector<int>& colors, int x) {
+    std::vector<int> result(colors.size());
+    for (size_t v = 0; v < colors.size(); ++v) {
+        result[v] = 2 * colors[v] + 1;
+    }
+    result[x]--;
+    return result;
+}
+
+std::vector<int> histogram(const std::vector<int>& colors) {
+    std::vector<int> counts(colors.size(), 0);
+    for (int c : colors) {
+        counts[c]++;
+    }
+    return counts;
+}
+
+// Smallest colour with more than one vertex, or -1 if the colouring is discrete
+int first_nonsingleton(const std::vector<int>& counts) {
+    for (size_t c = 0; c < counts.size(); ++c) {
+        if (counts[c] > 1) {
+            return static_cast<int>(c);
+        }
+    }
+    return -1;
+}
+
+class SymmetrySearch {
+public:
+    SymmetrySearch(const Graph& g, const std::vector<std::vector<int>>& clauses, size_t num_vars, size_t budget)
+        : g_(g), refiner_(g), num_vars_(num_vars), budget_(budget), orbit_(g.size()) {
+        std::iota(orbit_.begin(), orbit_.end(), 0);
+        for (const auto& clause : clauses) {
+            clause_set_.insert(normalized(clause));
+        }
+    }
+
+    // Walk down a chain of point stabilisers, looking at each level for
+    // automorphisms that map the individualized vertex to the others in its
+    // cell, skipping vertices already in its orbit
+    std::vector<Symmetry> run() {
+        std::vector<int> colors(g_.size(), 0);
+        for (size_t v = g_.num_literal_vertices; v < g_.size(); ++v) {
+            colors[v] = 1;
+        }
+        refiner_.refine(colors);
+
+        std::vector<int> image;
+        while (!exhausted_) {
+            std::vector<int> counts = histogram(colors);
+            int cell = first_nonsingleton(counts);
+            if (cell < 0) {
+                break;
+            }
+            int x = static_cast<int>(std::find(colors.begin(), colors.end(), cell) - colors.begin());
+            std::vector<int> left = individualize(colors, x);
+            refiner_.refine(left);
+            std::vector<int> left_counts = histogram(left);
+            for (size_t y = x + 1; y < g_.size() && !exhausted_; ++y) {
+                if (colors[y] != cell || find(static_cast<int>(y)) == find(x)) {
+                    continue;
+                }
+                std::vector<int> right = individualize(colors, static_cast<int>(y));
+                refiner_.refine(right);
+                if (histogram(right) == left_counts && match(left, right, image)) {
+                    record(image);
+                }
+            }
+            colors = std::move(left);
+        }
+        return generators_;
+    }
+
+private:
+    // Extend two compatible equitable colourings to an automorphism
+    bool match(const std::vector<int>& left, const std::vector<int>& right, std::vector<int>& image) {
+        if (budget_ == 0) {
+            exhausted_ = true;
+            return false;
+        }
+        budget_--;
+
+        std::vector<int> counts = histogram(left);
+        int cell = first_nonsingleton(counts);
+        if (cell < 0) {
+            std::vector<int> vertex_of_color(g_.size());
+            for (size_t v = 0; v < g_.size(); ++v) {
+                vertex_of_color[right[v]] = static_cast<int>(v);
+            }
+            image.resize(g_.size());
+            for (size_t v = 0; v < g_.size(); ++v) {
+                image[v] = vertex_of_color[left[v]];
+            }
+            return is_automorphism(image);
+        }
+
+        int a = static_cast<int>(std::find(left.begin(), left.end(), cell) - left.begin());
+        std::vector<int> next_left = individualize(left, a);
+        refiner_.refine(next_left);
+        std::vector<int> next_counts = histogram(next_left);
+        for (size_t b = 0; b < g_.size() && !exhausted_; ++b) {
+            if (right[b] != cell) {
+                continue;
+            }
+            std::vector<int> next_right = individualize(right, static_cast<int>(b));
+            refiner_.refine(next_right);
+            if (histogram(next_right) == next_counts && match(next_left, next_right, image)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // A vertex map is a formula symmetry if it keeps literals paired with
+    // their negations and maps every clause onto a clause
+    bool is_automorphism(const std::vector<int>& image) const {
+        for (size_t v = 0; v < g_.num_literal_vertices; v += 2) {
+            if (static_cast<size_t>(image[v]) >= g_.num_literal_vertices || image[v + 1] != (image[v] ^ 1)) {
+                return false;
+            }
+        }
+        std::vector<int> mapped;
+        for (const auto& clause : clause_set_) {
+            mapped.clear();
+            for (int lit : clause) {
+                mapped.push_back(vertex_literal(image[literal_vertex(lit)]));
+            }
+            std::sort(mapped.begin(), mapped.end());
+            if (clause_set_.count(mapped) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void record(const std::vector<int>& image) {
+        Symmetry symmetry(num_vars_ + 1, 0);
+        bool identity = true;
+        for (size_t var = 1; var <= num_vars_; ++var) {
+            symmetry[var] = vertex_literal(image[literal_vertex(static_cast<int>(var))]);
+            identity = identity && symmetry[var] == static_cast<int>(var);
+        }
+        for (size_t v = 0; v < image.size(); ++v) {
+            unite(static_cast<int>(v), image[v]);
+        }
+        if (!identity) {
+            generators_.push_back(std::move(symmetry));
+        }
+    }
+
+    static std::vector<int> normalized(const std::vector<int>& clause) {
+        std::vector<int> sorted(clause);
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        return sorted;
+    }
+
+    int find(int v) {
+        while (orbit_[v] != v) {
+            orbit_[v] = orbit_[orbit_[v]];
+            v = orbit_[v];
+        }
+        return v;
+    }
+
+    void unite(int a, int b) {
+        orbit_[find(a)] = find(b);
+    }
+
+    const Graph& g_;
+    Refiner refiner_;
+    size_t num_vars_;
+    size_t budget_;
+    bool exhausted_ = false;
+    std::set<std::vector<int>> clause_set_;
+    std::vector<int> orbit_; // union-find over orbits of the generators so far
+    std::vector<Symmetry> generators_;
+};
+
+} // namespace
+
+std::vector<Symmetry> find_symmetries(const Formula& formula, const SymmetryOptions& options) {
+    const auto& clauses = formula.get_clauses();
+    size_t num_vars = formula.num_variables();
+    // Structural formulas have no clauses to take symmetries of, and the
+    // graph does not model XOR constraints
+    if (formula.is_structural() || !formula.get_xors().empty() || num_vars == 0 || 2 * num_vars + clauses.size() > options.max_vertices) {
+        return {};
+    }
+    Graph g = build_graph(clauses, num_vars);
+    SymmetrySearch search(g, clauses, num_vars, options.max_nodes);
+    return search.run();
+}
+
+size_t add_symmetry_breaking(Formula& formula, const std::vector<Symmetry>& generators,
+                             const SymmetryOptions& options) {
+    // Lex-leader: every model's assignment must be no greater than its image
+    // under each generator, comparing the moved variables in index order.
+    // eq is defined as "the prefix so far is equal", so it is fixed by the
+    // original variables and never needs a split of its own.
+    size_t num_vars = formula.num_variables();
+    int next_var = static_cast<int>(num_vars) + 1;
+    size_t added = 0;
+    auto add = [&](std::vector<int> clause) {
+        std::sort(clause.begin(), clause.end());
+        clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+        formula.add_clause(clause);
+        added++;
+    };
+
+    for (const Symmetry& symmetry : generators) {
+        int eq = 0; // 0 while the prefix is empty
+        size_t length = 0;
+        for (size_t var = 1; var < symmetry.size() && length < options.max_prefix; ++var) {
+            int v = static_cast<int>(var);
+            int s = symmetry[var];
+            if (s == v) {
+                continue;
+            }
+            length++;
+
+            // Equal prefix -> v <= s
+            std::vector<int> clause = {-v, s};
+            if (eq != 0) {
+                clause.push_back(-eq);
+            }
+            add(clause);
+            if (s == -v || length == options.max_prefix) {
+                break; // the prefix cannot stay equal past v, or the chain ends
+            }
+
+            // next_eq <-> (eq and v == s)
+            int next_eq = next_var++;
+            std::vector<int> both_true = {-v, -s, next_eq};
+            std::vector<int> both_false = {v, s, next_eq};
+            if (eq != 0) {
+                both_true.push_back(-eq);
+                both_false.push_back(-eq);
+                add({-next_eq, eq});
+            }
+            add(both_true);
+            add(both_false);
+            add({-next_eq, -v, s});
+            add({-next_eq, v, -s});
+            eq = next_eq;
+        }
+    }
+    return added;
+}
+
+size_t break_symmetries(Formula& formula, const SymmetryOptions& options) {
+    std::vector<Symmetry> generators = find_symmetries(formula, options);
+    add_symmetry_breaking(formula, generators, options);
+    return generators.size();
+}
+
+} // namespace stalmarck
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../core/formula.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace stalmarck {
+
+// Symmetry detection and breaking, run on the clauses before encoding.
+//
+// A symmetry is a permutation of literals, closed under negation, that maps
+// the clause set onto itself. It is stored as image[v] = the literal v maps
+// to, for v in 1..num_variables (image[0] is unused).
+using Symmetry = std::vector<int>;
+
+struct SymmetryOptions {
+    size_t max_vertices = 200000; // skip formulas whose graph is larger
+    size_t max_nodes = 20000;     // search nodes before giving up
+    // Support variables per lex-leader chain, SIZE_MAX = the whole chain.
+    // Full chains prune far more once gates are recovered, but the clause
+    // encoding copes badly with their auxiliary clauses; use 1 there
+    size_t max_prefix = SIZE_MAX;
+};
+
+// Generators of the formula's symmetry group, found on its colored
+// clause-literal graph by partition refinement and individualization.
+// Every generator returned is verified against the clauses; the set may be
+// incomplete when the search budget runs out.
+std::vector<Symmetry> find_symmetries(const Formula& formula, const SymmetryOptions& options = {});
+
+// Add lex-leader symmetry-breaking clauses for each generator, ordering
+// variables by index. Auxiliary variables are numbered after the formula's
+// own, so models grow by them. Returns the number of clauses added.
+size_t add_symmetry_breaking(Formula& formula, const std::vector<Symmetry>& generators,
+                             const SymmetryOptions& options = {});
+
+// Both steps; call before the formula is encoded or solved. Returns the
+// number of generators found.
+size_t break_symmetries(Formula& formula, const SymmetryOptions& options = {});
+
+} // namespace stalmarck
@@ -0,0 +1,246 @@
+#include "generators.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+
+namespace stalmarck {
+namespace bench {
+
+namespace {
+
+// splitmix64, so generated instances are identical across standard libraries
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state_(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform integer in [0, bound)
+    int below(int bound) {
+        return static_cast<int>(next() % static_cast<uint64_t>(bound));
+    }
+
+    bool coin() {
+        return (next() >> 63) != 0;
+    }
+
+private:
+    uint64_t state_;
+};
+
+// Tseitin helpers; each returns the fresh output variable
+int add_and_gate(Instance& inst, int a, int b) {
+    int g = ++inst.num_vars;
+    inst.clauses.push_back({-g, a});
+    inst.clauses.push_back({-g, b});
+    inst.clauses.push_back({g, -a, -b});
+    return g;
+}
+
+int add_xor_gate(Instance& inst, int a, int b) {
+    int t = ++inst.num_vars;
+    inst.clauses.push_back({-t, a, b});
+    inst.clauses.push_back({-t, -a, -b});
+    inst.clauses.push_back({t, -a, b});
+    inst.clauses.push_back({t, a, -b});
+    return t;
+}
+
+int add_xor_chain(Instance& inst, const std::vector<int>& vars) {
+    int acc = vars[0];
+    for (size_t i = 1; i < vars.size(); ++i) {
+        acc = add_xor_gate(inst, acc, vars[i]);
+    }
+    return acc;
+}
+
+} // namespace
+
+double ksat_threshold(int k) {
+    // Empirical thresholds for small k; 2^k ln 2 is the asymptotic estimate
+    switch (k) {
+        case 2: return 1.0;
+        case 3: return 4.267;
+        case 4: return 9.931;
+        case 5: return 21.117;
+        case 6: return 43.37;
+        default: return std::ldexp(std::log(2.0), k);
+    }
+}
+
+Instance random_ksat(int num_vars, int k, double ratio, uint64_t seed) {
+    Rng rng(seed);
+    Instance inst;
+    std::ostringstream name;
+    name << "ksat" << k << "/n:" << num_vars;
+    inst.name = name.str();
+    inst.num_vars = num_vars;
+
+    int num_clauses = static_cast<int>(std::lround(ratio * num_vars));
+    std::vector<int> vars(num_vars);
+    std::iota(vars.begin(), vars.end(), 1);
+
+    for (int c = 0; c < num_clauses; ++c) {
+        // Partial Fisher-Yates picks k distinct variables
+        std::vector<int> clause;
+        for (int i = 0; i < k; ++i) {
+            int j = i + rng.below(num_vars - i);
+            std::swap(vars[i], vars[j]);
+            clause.push_back(rng.coin() ? vars[i] : -vars[i]);
+        }
+        inst.clauses.push_back(clause);
+    }
+    return inst;
+}
+
+Instance pigeonhole(int num_holes, int k_mult) {
+    Instance inst;
+    int num_pigeons = k_mult * num_holes + 1;
+    inst.name = "php/holes:" + std::to_string(num_holes);
+    inst.num_vars = num_pigeons * num_holes;
+
+    auto var = [num_holes](int pigeon, int hole) {
+        return pigeon * num_holes + hole + 1;
+    };
+
+    // Every pigeon sits in some hole
+    for (int p = 0; p < num_pigeons; ++p) {
+        std::vector<int> clause;
+        for (int h = 0; h < num_holes; ++h) {
+            clause.push_back(var(p, h));
+        }
+        inst.clauses.push_back(clause);
+    }
+
+    // No hole holds more than k_mult pigeons
+    for (int h = 0; h < num_holes; ++h) {
+        std::vector<int> subset(k_mult + 1);
+        std::iota(subset.begin(), subset.end(), 0);
+        while (true) {
+            std::vector<int> clause;
+            for (int p : subset) {
+                clause.push_back(-var(p, h));
+            }
+            inst.clauses.push_back(clause);
+
+            // Advance to the next (k_mult + 1)-subset of pigeons
+            int i = k_mult;
+            while (i >= 0 && subset[i] == num_pigeons - k_mult - 1 + i) {
+                --i;
+            }
+            if (i < 0) {
+                break;
+            }
+            ++subset[i];
+            for (int j = i + 1; j <= k_mult; ++j) {
+                subset[j] = subset[j - 1] + 1;
+            }
+        }
+    }
+    return inst;
+}
+
+Instance parity_chain(int num_vars, bool satisfiable, uint64_t seed) {
+    Rng rng(seed);
+    Instance inst;
+    inst.name = std::string(satisfiable ? "parity_sat" : "parity_unsat") +
+                "/n:" + std::to_string(num_vars);
+    inst.num_vars = num_vars;
+
+    std::vector<int> order(num_vars);
+    std::iota(order.begin(), order.end(), 1);
+    int first = add_xor_chain(inst, order);
+
+    // The same parity computed in a different order must agree with the first
+    for (int i = num_vars - 1; i > 0; --i) {
+        std::swap(order[i], order[rng.below(i + 1)]);
+    }
+    int second = add_xor_chain(inst, order);
+
+    inst.clauses.push_back({first});
+    inst.clauses.push_back({satisfiable ? second : -second});
+    return inst;
+}
+
+Instance equivalence_miter(int num_inputs, int num_gates, bool buggy, uint64_t seed) {
+    Rng rng(seed);
+    Instance inst;
+    inst.name = std::string(buggy ? "miter_buggy" : "miter") +
+                "/gates:" + std::to_string(num_gates);
+    inst.num_vars = num_inputs;
+
+    // Random AND/inverter graph over the inputs
+    struct Gate { int a; int b; };
+    std::vector<Gate> gates;
+    for (int g = 0; g < num_gates; ++g) {
+        int pool = num_inputs + g;
+        // Operands index inputs (1..num_inputs) or earlier gates (num_inputs+1..)
+        int a = 1 + rng.below(pool);
+        int b = 1 + rng.below(pool);
+        gates.push_back({rng.coin() ? a : -a, rng.coin() ? b : -b});
+    }
+    int bug = buggy ? rng.below(num_gates) : -1;
+
+    // Build both copies; the second swaps operands, which is equivalent
+    auto build = [&](bool second_copy) {
+        std::vector<int> node(num_inputs + num_gates + 1);
+        for (int i = 1; i <= num_inputs; ++i) {
+            node[i] = i;
+        }
+        auto lit = [&node](int operand) {
+            return operand > 0 ? node[operand] : -node[-operand];
+        };
+        for (int g = 0; g < num_gates; ++g) {
+            int a = lit(gates[g].a);
+            int b = lit(gates[g].b);
+            if (second_copy) {
+                std::swap(a, b);
+                if (g == bug) {
+                    a = -a;
+                }
+            }
+            node[num_inputs + g + 1] = add_and_gate(inst, a, b);
+        }
+        return node;
+    };
+    std::vector<int> left = build(false);
+    std::vector<int> right = build(true);
+
+    // The miter asserts that some output pair differs
+    int num_outputs = std::min(num_gates, 4);
+    std::vector<int> miter;
+    for (int o = 0; o < num_outputs; ++o) {
+        int idx = num_inputs + num_gates - o;
+        miter.push_back(add_xor_gate(inst, left[idx], right[idx]));
+    }
+    inst.clauses.push_back(miter);
+    return inst;
+}
+
+void write_dimacs(const Instance& instance, std::ostream& out) {
+    out << "c " << instance.name << "\n";
+    out << "p cnf " << instance.num_vars << " " << instance.clauses.size() << "\n";
+    for (const auto& clause : instance.clauses) {
+        for (int lit : clause) {
+            out << lit << " ";
+        }
+        out << "0\n";
+    }
+}
+
+Formula to_formula(const Instance& instance) {
+    Formula formula;
+    for (const auto& clause : instance.clauses) {
+        formula.add_clause(clause);
+    }
+    return formula;
+}
+
+} // namespace bench
+} // namespace stalmarck
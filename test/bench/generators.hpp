@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/formula.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace stalmarck {
+namespace bench {
+
+// A generated CNF instance, kept as plain clauses so it can be written out as
+// DIMACS (to time the parser) or loaded straight into a Formula.
+struct Instance {
+    std::string name;
+    int num_vars = 0;
+    std::vector<std::vector<int>> clauses;
+};
+
+// Clause/variable ratio at the satisfiability phase transition for random k-SAT
+double ksat_threshold(int k);
+
+// Instance families
+Instance random_ksat(int num_vars, int k, double ratio, uint64_t seed);
+Instance pigeonhole(int num_holes, int k_mult = 1);
+Instance parity_chain(int num_vars, bool satisfiable, uint64_t seed);
+Instance equivalence_miter(int num_inputs, int num_gates, bool buggy, uint64_t seed);
+
+// Output helpers
+void write_dimacs(const Instance& instance, std::ostream& out);
+Formula to_formula(const Instance& instance);
+
+} // namespace bench
+} // namespace stalmarck
@@ -1,7 +1,23 @@
 #include <gtest/gtest.h>
 #include <filesystem>
 #include "core/stalmarck.hpp"
+#include "core/batch.hpp"
+#include "core/cube.hpp"
+#include "core/portfolio.hpp"
+#include "core/server.hpp"
+#include "core/line_io.hpp"
+#include "core/result_cache.hpp"
 #include "parser/parser.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 namespace stalmarck {
 namespace test {
@@ -86,5 +102,380 @@ TEST_F(IntegrationTests, SolveAllCNFs) {
     std::cout << "\nPassed " << passed << " out of " << files.size() << " tests\n";
 }
 
+TEST_F(IntegrationTests, BatchSolveAllCNFs) {
+    BatchSolver batch;
+    batch.set_threads(2);
+    ASSERT_TRUE(batch.add_directory(getTestCasesPath()));
+    EXPECT_EQ(batch.size(), getCNFFiles().size());
+
+    size_t results = 0;
+    batch.run([&](const BatchResult& result) {
+        results++;
+        EXPECT_TRUE(result.error.empty()) << result.error;
+        SolveStatus expected = expectedResult(result.name) ? SolveStatus::SAT : SolveStatus::UNSAT;
+        EXPECT_EQ(result.status, expected) << "Wrong result for " << result.name;
+        EXPECT_NE(to_json_line(result).find("\"name\": \"" + result.name + "\""), std::string::npos);
+    });
+    EXPECT_EQ(results, batch.size());
+}
+
+TEST_F(IntegrationTests, CubeAndConquerAllCNFs) {
+    for (const auto& filename : getCNFFiles()) {
+        Parser parser;
+        Formula formula = parser.parse_dimacs(getTestCasesPath() + "/" + filename);
+        ASSERT_FALSE(parser.has_error()) << parser.get_error();
+
+        CubeSolver cubes;
+        cubes.set_workers(3);
+        cubes.set_depth(3);
+        ASSERT_TRUE(cubes.solve(formula)) << cubes.get_error();
+
+        SolveStatus expected = expectedResult(filename) ? SolveStatus::SAT : SolveStatus::UNSAT;
+        EXPECT_EQ(cubes.get_status(), expected) << "Wrong result for " << filename;
+        if (expected == SolveStatus::SAT) {
+            EXPECT_EQ(cubes.get_model().size(), formula.num_variables());
+        }
+    }
+}
+
+TEST_F(IntegrationTests, PortfolioAllCNFs) {
+    for (const auto& filename : getCNFFiles()) {
+        Parser parser;
+        Formula formula = parser.parse_dimacs(getTestCasesPath() + "/" + filename);
+        ASSERT_FALSE(parser.has_error()) << parser.get_error();
+
+        PortfolioSolver portfolio;
+        portfolio.set_threads(4);
+        ASSERT_TRUE(portfolio.solve(formula));
+
+        SolveStatus expected = expectedResult(filename) ? SolveStatus::SAT : SolveStatus::UNSAT;
+        EXPECT_EQ(portfolio.get_status(), expected) << "Wrong result for " << filename;
+        EXPECT_FALSE(portfolio.get_winner().empty());
+        if (expected == SolveStatus::SAT) {
+            EXPECT_EQ(portfolio.get_model().size(), formula.num_variables());
+        }
+    }
+}
+
+TEST_F(IntegrationTests, CubeWorkerCommandKeepsFormulaOptions) {
+    // Pigeonhole 5 -> 4 as a tautology: it is valid only if exec'd workers
+    // negate it too
+    const int holes = 4;
+    auto var = [](int pigeon, int hole) {
+        return "p" + std::to_string(pigeon) + "h" + std::to_string(hole);
+    };
+    std::string text = "!(";
+    for (int p = 0; p <= holes; ++p) {
+        text += p > 0 ? " & (" : "(";
+        for (int h = 0; h < holes; ++h) {
+            text += (h > 0 ? " | " : "") + var(p, h);
+        }
+        text += ")";
+    }
+    for (int h = 0; h < holes; ++h) {
+        for (int p = 0; p <= holes; ++p) {
+            for (int q = p + 1; q <= holes; ++q) {
+                text += " & !(" + var(p, h) + " & " + var(q, h) + ")";
+            }
+        }
+    }
+    text += ")\n";
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("stalmarck_php_" + std::to_string(getpid()) + ".prop")).string();
+    std::ofstream(path) << text;
+
+    for (const std::string extra : {"", " --gates"}) {
+        std::string command = std::string(STALMARCK_CLI) + " --tautology" + extra +
+                              " --cubes 2 --jobs 2 --worker-cmd " + STALMARCK_CLI + " " + path;
+        FILE* pipe = popen(command.c_str(), "r");
+        ASSERT_NE(pipe, nullptr);
+        char buffer[256];
+        std::string output;
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+            output += buffer;
+        }
+        pclose(pipe);
+        EXPECT_EQ(output, "TAUTOLOGY\n") << command;
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_F(IntegrationTests, LocalSearchAllCNFs) {
+    for (const auto& filename : getCNFFiles()) {
+        Parser parser;
+        Formula formula = parser.parse_dimacs(getTestCasesPath() + "/" + filename);
+        ASSERT_FALSE(parser.has_error()) << parser.get_error();
+        SolveStatus expected = expectedResult(filename) ? SolveStatus::SAT : SolveStatus::UNSAT;
+
+        // UNSAT instances fall through to the complete search
+        StalmarckSolver solver;
+        solver.set_local_search(0.05);
+        ASSERT_TRUE(solver.solve(formula));
+        EXPECT_EQ(solver.get_status(), expected) << "Wrong result for " << filename;
+        if (expected == SolveStatus::SAT) {
+            EXPECT_EQ(solver.get_model().size(), formula.num_variables());
+        }
+
+        PortfolioSolver portfolio;
+        portfolio.set_threads(2);
+        portfolio.set_local_search(true);
+        ASSERT_TRUE(portfolio.solve(formula));
+        EXPECT_EQ(portfolio.get_status(), expected) << "Wrong result for " << filename;
+    }
+}
+
+TEST_F(IntegrationTests, SolveAsyncMatchesSolve) {
+    for (const auto& filename : getCNFFiles()) {
+        Parser parser;
+        Formula formula = parser.parse_dimacs(getTestCasesPath() + "/" + filename);
+        ASSERT_FALSE(parser.has_error()) << parser.get_error();
+
+        StalmarckSolver solver;
+        SolveHandle handle = solver.solve_async(formula);
+        ASSERT_TRUE(handle.valid());
+        SolveStatus expected = expectedResult(filename) ? SolveStatus::SAT : SolveStatus::UNSAT;
+        EXPECT_EQ(handle.wait(), expected) << "Wrong result for " << filename;
+        EXPECT_TRUE(handle.ready());
+        EXPECT_EQ(solver.get_status(), expected);
+    }
+}
+
+TEST_F(IntegrationTests, AsyncHandleErrors) {
+    // A default-constructed handle has no solve behind it
+    SolveHandle empty;
+    EXPECT_FALSE(empty.valid());
+    EXPECT_FALSE(empty.ready());
+    EXPECT_FALSE(empty.wait_for(0.0));
+    EXPECT_EQ(empty.wait(), SolveStatus::UNKNOWN);
+    empty.cancel();
+
+    // What the solve throws comes out of wait()
+    Formula formula;
+    formula.add_clause({1, 2});
+    formula.add_clause({-1, 2});
+    StalmarckSolver solver;
+    solver.set_progress_callback([](const SolverProgress&) {
+        throw std::runtime_error("progress failed");
+    }, 0.0);
+    SolveHandle handle = solver.solve_async(formula);
+    EXPECT_THROW(handle.wait(), std::runtime_error);
+    EXPECT_TRUE(handle.ready());
+}
+
+TEST_F(IntegrationTests, CancelAsyncSolveWithProgress) {
+    // Pigeonhole 10 -> 9: far beyond what the search finishes quickly
+    const int holes = 9;
+    auto var = [](int pigeon, int hole) { return pigeon * holes + hole + 1; };
+    Formula formula;
+    for (int p = 0; p <= holes; ++p) {
+        std::vector<int> clause;
+        for (int h = 0; h < holes; ++h) {
+            clause.push_back(var(p, h));
+        }
+        formula.add_clause(clause);
+    }
+    for (int h = 0; h < holes; ++h) {
+        for (int p = 0; p <= holes; ++p) {
+            for (int q = p + 1; q <= holes; ++q) {
+                formula.add_clause({-var(p, h), -var(q, h)});
+            }
+        }
+    }
+
+    StalmarckSolver solver;
+    std::atomic<int> reports{0};
+    std::atomic<uint64_t> last_decisions{0};
+    solver.set_progress_callback([&](const SolverProgress& progress) {
+        EXPECT_GE(progress.decisions, last_decisions.load());
+        last_decisions = progress.decisions;
+        reports++;
+    }, 0.0);
+
+    SolveHandle handle = solver.solve_async(formula);
+    while (reports < 10 && !handle.ready()) {
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(handle.wait_for(0.0));
+    handle.cancel();
+    EXPECT_TRUE(handle.wait_for(10.0));
+    EXPECT_EQ(handle.wait(), SolveStatus::UNKNOWN);
+    EXPECT_GE(reports, 10);
+}
+
+TEST_F(IntegrationTests, ServeSolvesAndCachesFormulas) {
+    std::string socket_path = (std::filesystem::temp_directory_path() /
+                               ("stalmarck_test_" + std::to_string(::getpid()) + ".sock")).string();
+    SolverServer server;
+    server.set_workers(2);
+    server.set_cache_size(8);
+    ASSERT_TRUE(server.listen(socket_path)) << server.get_error();
+    std::thread serving([&server] { server.run(); });
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    LineReader reader(fd);
+    auto request = [&](const std::string& text) {
+        std::string line;
+        EXPECT_TRUE(write_all(fd, text, true));
+        EXPECT_TRUE(reader.read_line(line));
+        return line.substr(0, line.find(' '));
+    };
+
+    // Every instance twice: the second round is served from the cache
+    auto files = getCNFFiles();
+    for (int round = 0; round < 2; ++round) {
+        for (const auto& filename : files) {
+            std::string expected = expectedResult(filename) ? "SAT" : "UNSAT";
+            EXPECT_EQ(request("solve file " + getTestCasesPath() + "/" + filename + "\n"), expected)
+                << "Wrong result for " << filename;
+        }
+    }
+    EXPECT_EQ(request("solve timeout 5 inline\np cnf 2 4\n1 2 0\n-1 2 0\n1 -2 0\n-1 -2 0\nend\n"), "UNSAT");
+    EXPECT_EQ(request("solve file /nonexistent.cnf\n"), "ERROR");
+    EXPECT_EQ(request("solve sideways file x.cnf\n"), "ERROR");
+
+    std::string stats;
+    ASSERT_TRUE(write_all(fd, "stats\n", true));
+    ASSERT_TRUE(reader.read_line(stats));
+    std::istringstream in(stats);
+    std::string word;
+    uint64_t hits = 0;
+    while (in >> word) {
+        if (word == "hits") {
+            in >> hits;
+        }
+    }
+    EXPECT_GE(hits, files.size() / 2) << stats;
+
+    ::close(fd);
+    server.stop();
+    serving.join();
+    EXPECT_FALSE(std::filesystem::exists(socket_path));
+}
+
+TEST_F(IntegrationTests, FormulaCacheEvictsLeastRecentlyUsed) {
+    FormulaCache cache(2);
+    cache.put(1, std::make_shared<const Formula>());
+    cache.put(2, std::make_shared<const Formula>());
+    EXPECT_NE(cache.get(1), nullptr);  // 2 is now the oldest
+    cache.put(3, std::make_shared<const Formula>());
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_NE(cache.get(1), nullptr);
+    EXPECT_EQ(cache.get(2), nullptr);
+    EXPECT_NE(cache.get(3), nullptr);
+    EXPECT_NE(content_hash("p cnf 1 1\n1 0\n"), content_hash("p cnf 1 1\n-1 0\n"));
+}
+
+TEST_F(IntegrationTests, ResultCacheAnswersRepeatedInstances) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                      ("stalmarck_cache_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(directory);
+
+    ResultCache cache(directory.string());
+    CachedResult result;
+    EXPECT_FALSE(cache.lookup(42, result));
+    ASSERT_TRUE(cache.store(42, SolveStatus::SAT, {1, -2, 3})) << cache.get_error();
+    ASSERT_TRUE(cache.lookup(42, result));
+    EXPECT_EQ(result.status, SolveStatus::SAT);
+    EXPECT_EQ(result.model, (std::vector<int>{1, -2, 3}));
+    EXPECT_EQ(result.version, ResultCache::solver_version());
+    EXPECT_TRUE(cache.store(43, SolveStatus::UNKNOWN, {}));
+    EXPECT_FALSE(cache.lookup(43, result));
+
+    // The second batch run is answered entirely from the cache
+    for (int round = 0; round < 2; ++round) {
+        BatchSolver batch;
+        batch.set_threads(2);
+        batch.set_result_cache(directory.string());
+        for (const auto& filename : getCNFFiles()) {
+            batch.add_file(getTestCasesPath() + "/" + filename, filename);
+        }
+        batch.run([&](const BatchResult& r) {
+            SolveStatus expected = expectedResult(r.name) ? SolveStatus::SAT : SolveStatus::UNSAT;
+            EXPECT_EQ(r.status, expected) << "Wrong result for " << r.name;
+            EXPECT_EQ(r.cached, round == 1) << r.name;
+        });
+    }
+
+    // Preprocessing changes what is solved, so it keys its own entries
+    EXPECT_EQ(ResultCache::key(42, false, 0, false, false), 42u);
+    EXPECT_NE(ResultCache::key(42, false, 0, false, true), 42u);
+    EXPECT_NE(ResultCache::key(42, true, 1, false, false), ResultCache::key(42, true, 2, false, false));
+    for (int round = 0; round < 2; ++round) {
+        BatchSolver batch;
+        batch.set_result_cache(directory.string());
+        batch.set_gate_recovery(true);
+        for (const auto& filename : getCNFFiles()) {
+            batch.add_file(getTestCasesPath() + "/" + filename, filename);
+        }
+        batch.run([&](const BatchResult& r) {
+            EXPECT_EQ(r.cached, round == 1) << r.name;
+        });
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(IntegrationTests, SolveAigerMiters) {
+    // Miter of two XOR circuits, (x & -y) | (-x & y) against (x | y) & -(x & y):
+    // the output is 1 exactly where they differ
+    auto miter = [](const std::string& second_xor) {
+        return "aag 11 2 0 1 9\n2\n4\n23\n"
+               "6 2 5\n8 3 4\n10 7 9\n"   // 11 = first XOR
+               "12 3 5\n14 2 4\n" + second_xor +
+               "18 11 17\n20 10 16\n22 19 21\n";
+    };
+    auto dir = std::filesystem::temp_directory_path() / "stalmarck_aiger_test";
+    std::filesystem::create_directories(dir);
+    std::string equivalent = (dir / "equivalent.aag").string();
+    std::string different = (dir / "different.aag").string();
+    std::ofstream(equivalent) << miter("16 13 15\n");
+    std::ofstream(different) << miter("16 13 13\n");  // second "XOR" is just x | y
+
+    StalmarckSolver solver;
+    ASSERT_TRUE(solver.solve(equivalent));
+    EXPECT_EQ(solver.get_status(), SolveStatus::UNSAT);
+
+    ASSERT_TRUE(solver.solve(different));
+    EXPECT_EQ(solver.get_status(), SolveStatus::SAT);
+    // The circuits differ only at x = y = 1; inputs are variables 1 and 2
+    const auto& model = solver.get_model();
+    ASSERT_GE(model.size(), 2u);
+    EXPECT_GT(model[0], 0);
+    EXPECT_GT(model[1], 0);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(IntegrationTests, CheckTautologies) {
+    struct Case {
+        const char* text;
+        bool tautology;
+        bool satisfiable;
+    };
+    const Case cases[] = {
+        {"((p -> q) -> p) -> p", true, true},                          // Peirce's law
+        {"let a = x & y; let b = !(!x | !y); a <-> b", true, true},
+        {"(p -> q) -> (q -> p)", false, true},
+        {"(p <-> q) <-> (q <-> r) <-> p", false, true},
+        {"p & (p -> q) & !q", false, false},
+        {"(a | b) & (a -> c) & (b -> c) -> c", true, true},
+    };
+    Parser parser;
+    StalmarckSolver solver;
+    for (const auto& c : cases) {
+        Formula formula = parser.parse_expression_string(c.text);
+        ASSERT_FALSE(parser.has_error()) << parser.get_error();
+        ASSERT_TRUE(solver.solve(formula));
+        EXPECT_EQ(solver.get_status() == SolveStatus::SAT, c.satisfiable) << c.text;
+
+        Formula negated = parser.parse_expression_string(c.text, true);
+        ASSERT_TRUE(solver.solve(negated));
+        EXPECT_EQ(solver.get_status() == SolveStatus::UNSAT, c.tautology) << c.text;
+    }
+}
+
 } // namespace test
 } // namespace stalmarck
\ No newline at end of file
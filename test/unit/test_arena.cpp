@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "core/arena.hpp"
+#include "core/formula.hpp"
+#include "solver/solver.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace stalmarck {
+namespace test {
+
+TEST(ArenaTests, AllocationsAreAlignedAndDisjoint) {
+    Arena arena(256);
+    int8_t* bytes = arena.allocate<int8_t>(3);
+    int64_t* words = arena.allocate<int64_t>(4);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(words) % alignof(int64_t), 0u);
+    EXPECT_TRUE(reinterpret_cast<int8_t*>(words) >= bytes + 3);
+
+    int* zeroed = arena.allocate_zeroed<int>(8);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(zeroed[i], 0);
+    }
+}
+
+TEST(ArenaTests, ResetKeepsCapacity) {
+    Arena arena(128);
+
+    // Spill over several blocks, then reset
+    for (int i = 0; i < 10; ++i) {
+        arena.allocate<int>(64);
+    }
+    size_t capacity = arena.capacity();
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.capacity(), capacity);
+
+    // The same workload now fits without growing
+    for (int i = 0; i < 10; ++i) {
+        arena.allocate<int>(64);
+    }
+    EXPECT_EQ(arena.capacity(), capacity);
+}
+
+TEST(ArenaTests, ResetReusesSpilledBlocks) {
+    Arena arena(128);
+    std::vector<int*> first;
+    for (int i = 0; i < 10; ++i) {
+        first.push_back(arena.allocate<int>(24));
+    }
+
+    // A reset rewinds; the same workload gets the same memory back
+    arena.reset();
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(arena.allocate<int>(24), first[i]);
+    }
+}
+
+TEST(ArenaTests, SolverReuseDoesNotGrowArena) {
+    Solver solver;
+    Formula formula;
+    formula.add_clause({1, 2});
+    formula.add_clause({3, 4});
+    formula.add_clause({-1, -3});
+    formula.add_clause({-2, -4});
+
+    solver.solve(formula);
+    size_t capacity = solver.arena_capacity();
+    EXPECT_GT(capacity, 0u);
+
+    solver.solve(formula);
+    EXPECT_EQ(solver.arena_capacity(), capacity);
+}
+
+} // namespace test
+} // namespace stalmarck
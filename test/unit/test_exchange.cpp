@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "solver/exchange.hpp"
+#include "solver/solver.hpp"
+#include "core/formula.hpp"
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace stalmarck {
+namespace test {
+
+namespace {
+
+Fact make_clause(uint16_t source, std::vector<int> literals) {
+    Fact fact;
+    fact.kind = FactKind::Clause;
+    fact.source = source;
+    fact.size = static_cast<uint8_t>(literals.size());
+    for (size_t i = 0; i < literals.size(); ++i) {
+        fact.literals[i] = literals[i];
+    }
+    return fact;
+}
+
+} // namespace
+
+TEST(ExchangeTests, PublishedFactsArePolledInOrder) {
+    FactExchange exchange(16);
+    EXPECT_EQ(exchange.capacity(), 16u);
+
+    EXPECT_TRUE(exchange.publish(make_clause(1, {1, -2})));
+    EXPECT_TRUE(exchange.publish(make_clause(2, {3, 4, -5})));
+
+    ExchangeCursor cursor;
+    std::vector<Fact> facts;
+    EXPECT_EQ(exchange.poll(cursor, facts), 2u);
+    ASSERT_EQ(facts.size(), 2u);
+    EXPECT_EQ(facts[0].source, 1);
+    EXPECT_EQ(facts[0].size, 2);
+    EXPECT_EQ(facts[0].literals[1], -2);
+    EXPECT_EQ(facts[1].kind, FactKind::Clause);
+    EXPECT_EQ(facts[1].literals[2], -5);
+
+    // Nothing new until another fact is published
+    EXPECT_EQ(exchange.poll(cursor, facts), 0u);
+    exchange.publish(make_clause(1, {7}));
+    EXPECT_EQ(exchange.poll(cursor, facts), 1u);
+    EXPECT_EQ(facts.back().literals[0], 7);
+}
+
+TEST(ExchangeTests, LappedReaderSkipsToOldestFact) {
+    FactExchange exchange(4);
+    for (int i = 1; i <= 10; ++i) {
+        exchange.publish(make_clause(0, {i}));
+    }
+
+    ExchangeCursor cursor;
+    std::vector<Fact> facts;
+    EXPECT_EQ(exchange.poll(cursor, facts), 4u);
+    ASSERT_EQ(facts.size(), 4u);
+    EXPECT_EQ(facts.front().literals[0], 7);
+    EXPECT_EQ(facts.back().literals[0], 10);
+}
+
+TEST(ExchangeTests, ConcurrentPublishersNeverTearFacts) {
+    FactExchange exchange(64);
+    const int publishers = 4;
+    const int per_publisher = 5000;
+
+    // Every fact repeats one value, so a torn read shows up as a mismatch
+    std::vector<std::thread> threads;
+    for (int p = 0; p < publishers; ++p) {
+        threads.emplace_back([&exchange, p] {
+            for (int i = 1; i <= per_publisher; ++i) {
+                int value = p * per_publisher + i;
+                exchange.publish(make_clause(static_cast<uint16_t>(p), {value, value, value, value}));
+            }
+        });
+    }
+
+    size_t read = 0;
+    ExchangeCursor cursor;
+    std::vector<Fact> facts;
+    while (exchange.published() < publishers * per_publisher || read == 0) {
+        facts.clear();
+        read += exchange.poll(cursor, facts);
+        for (const Fact& fact : facts) {
+            ASSERT_EQ(fact.size, 4);
+            ASSERT_EQ((fact.literals[0] - 1) / per_publisher, fact.source);
+            for (int i = 1; i < 4; ++i) {
+                ASSERT_EQ(fact.literals[i], fact.literals[0]);
+            }
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(exchange.published(), static_cast<uint64_t>(publishers * per_publisher));
+}
+
+TEST(ExchangeTests, SolverSharesOnlyRefutedPaths) {
+    // Satisfiable, with models 1 -2 -3 and -1 2 -3; a search whose
+    // candidate models fail to verify has refuted nothing, so every
+    // clause it shares must still hold in both models
+    Formula formula;
+    formula.add_clause({1, 2, 3});
+    formula.add_clause({-1, -2});
+    formula.add_clause({-2, -3});
+    formula.add_clause({2, -3});
+
+    FactExchange exchange(256);
+    Solver solver;
+    solver.set_exchange(&exchange, 1, 8);
+    solver.solve(formula);
+
+    ExchangeCursor cursor;
+    std::vector<Fact> facts;
+    exchange.poll(cursor, facts);
+    for (const std::vector<int>& model : {std::vector<int>{1, -2, -3}, std::vector<int>{-1, 2, -3}}) {
+        for (const Fact& fact : facts) {
+            bool holds = false;
+            bool problem_only = true;
+            for (size_t i = 0; i < fact.size; ++i) {
+                size_t var = static_cast<size_t>(std::abs(fact.literals[i]));
+                problem_only &= var <= model.size();
+                holds |= var <= model.size() && model[var - 1] == fact.literals[i];
+            }
+            if (fact.kind != FactKind::Equivalence && problem_only) {
+                EXPECT_TRUE(holds);
+            }
+        }
+    }
+}
+
+} // namespace test
+} // namespace stalmarck
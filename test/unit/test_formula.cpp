@@ -1,5 +1,11 @@
 #include <gtest/gtest.h>
 #include "core/formula.hpp"
+#include "core/gates.hpp"
+#include "solver/solver.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <thread>
 
 namespace stalmarck {
 namespace test {
@@ -111,5 +117,284 @@ TEST(FormulaTests, GetTripletsAutoTranslation) {
     EXPECT_EQ(triplets.size(), explicit_triplets.size());
 }
 
+// Test bulk loading of 0-terminated clauses
+TEST(FormulaTests, AddClausesFromFlatArray) {
+    Formula formula;
+    const int literals[] = {1, -2, 0, 3, 0, -1, 2, 4};
+    formula.add_clauses(literals, sizeof(literals) / sizeof(literals[0]));
+
+    ASSERT_EQ(3, formula.num_clauses());
+    EXPECT_EQ(4, formula.num_variables());
+    EXPECT_EQ((std::vector<int>{3}), formula.get_clauses()[1]);
+    EXPECT_EQ((std::vector<int>{-1, 2, 4}), formula.get_clauses()[2]);
+}
+
+// Test that reordering is a renumbering of the same triplets
+TEST(FormulaTests, ReorderForLocality) {
+    Formula formula;
+    formula.add_clause({1, 5, 3});
+    formula.add_clause({-2, 4});
+    formula.add_clause({5, -1, 2});
+    formula.add_clause({-3, -4, 5});
+
+    std::vector<std::tuple<int, int, int>> before = formula.get_triplets();
+    formula.reorder_for_locality();
+    const auto& after = formula.get_triplets();
+    ASSERT_EQ(before.size(), after.size());
+
+    // Problem variables stay within 1..num_variables() and map back one-to-one
+    std::vector<bool> seen(formula.num_variables() + 1, false);
+    for (int v = 1; v <= static_cast<int>(formula.num_variables()); ++v) {
+        int original = formula.original_variable(v);
+        ASSERT_GE(original, 1);
+        ASSERT_LE(original, static_cast<int>(formula.num_variables()));
+        EXPECT_FALSE(seen[original]);
+        seen[original] = true;
+    }
+
+    // Mapping the reordered triplets back yields the original triplet set
+    auto to_original = [&formula](int lit) {
+        return lit < 0 ? -formula.original_variable(-lit) : formula.original_variable(lit);
+    };
+    std::vector<std::tuple<int, int, int>> mapped;
+    for (const auto& [x, y, z] : after) {
+        mapped.emplace_back(to_original(x), to_original(y), to_original(z));
+    }
+    std::sort(before.begin(), before.end());
+    std::sort(mapped.begin(), mapped.end());
+    EXPECT_EQ(before, mapped);
+}
+
+// Test that triplets are grouped by kind and the offsets bound each group
+TEST(FormulaTests, TripletsGroupedByKind) {
+    EXPECT_EQ(TripletKind::General, classify_triplet(1, 2, 3));
+    EXPECT_EQ(TripletKind::XEqualsY, classify_triplet(-4, -4, 2));
+    EXPECT_EQ(TripletKind::YEqualsZ, classify_triplet(1, 2, 2));
+    EXPECT_EQ(TripletKind::General, classify_triplet(1, 2, -2));
+    EXPECT_EQ(TripletKind::AllEqual, classify_triplet(3, 3, 3));
+
+    Formula formula;
+    formula.add_clause({1, 1, 2});
+    formula.add_clause({-2, 3});
+    formula.add_clause({3, 3});
+    formula.add_clause({-1, -3});
+
+    const auto& triplets = formula.get_triplets();
+    const TripletKindOffsets& offsets = formula.get_triplet_kind_offsets();
+    EXPECT_EQ(0u, offsets[0]);
+    EXPECT_EQ(triplets.size(), offsets[NUM_TRIPLET_KINDS]);
+    for (size_t k = 0; k < NUM_TRIPLET_KINDS; ++k) {
+        ASSERT_LE(offsets[k], offsets[k + 1]);
+        for (size_t i = offsets[k]; i < offsets[k + 1]; ++i) {
+            const auto& [x, y, z] = triplets[i];
+            EXPECT_EQ(k, static_cast<size_t>(classify_triplet(x, y, z)));
+        }
+    }
+
+    // Reordering keeps the grouping
+    formula.reorder_for_locality();
+    for (size_t k = 0; k < NUM_TRIPLET_KINDS; ++k) {
+        for (size_t i = offsets[k]; i < offsets[k + 1]; ++i) {
+            const auto& [x, y, z] = formula.get_triplets()[i];
+            EXPECT_EQ(k, static_cast<size_t>(classify_triplet(x, y, z)));
+        }
+    }
+}
+
+TEST(FormulaTests, CanonicalHashIgnoresClauseAndLiteralOrder) {
+    Formula a;
+    a.add_clause({1, -2, 3});
+    a.add_clause({-1, 2});
+    a.add_clause({2, 3});
+
+    Formula b;
+    b.add_clause({3, 2});
+    b.add_clause({3, 1, -2});
+    b.add_clause({2, -1});
+    EXPECT_EQ(a.canonical_hash(), b.canonical_hash());
+
+    // The clauses themselves are left as they were added
+    EXPECT_EQ(b.get_clauses()[0], (std::vector<int>{3, 2}));
+
+    Formula c;
+    c.add_clause({1, -2, 3});
+    c.add_clause({-1, 2});
+    c.add_clause({2, -3});
+    EXPECT_NE(a.canonical_hash(), c.canonical_hash());
+
+    // A repeated clause still changes the key
+    b.add_clause({2, 3});
+    EXPECT_NE(a.canonical_hash(), b.canonical_hash());
+}
+
+TEST(FormulaTests, RecoverGatesKeepsModels) {
+    std::vector<std::vector<int>> clauses = {
+        {-3, 1}, {-3, 2}, {3, -1, -2},                // 3 = 1 & 2
+        {4, -1}, {4, -2}, {-4, 1, 2},                 // 4 = 1 | 2
+        {-5, 1, 2}, {-5, -1, -2}, {5, -1, 2}, {5, 1, -2}, // 5 = 1 ^ 2
+        {-6, -1, 2}, {-6, 1, 4}, {6, -1, -2}, {6, 1, -4}, // 6 = 1 ? 2 : 4
+        {3, 5, -6}, {-4}                              // residual
+    };
+    Formula formula;
+    for (const auto& clause : clauses) {
+        formula.add_clause(clause);
+    }
+    GateStats stats = recover_gates(formula);
+    EXPECT_TRUE(formula.is_structural());
+    EXPECT_EQ(stats.and_gates, 2);
+    EXPECT_EQ(stats.xor_gates, 1);
+    EXPECT_EQ(stats.ite_gates, 1);
+    EXPECT_EQ(stats.residual_clauses, 2);
+
+    // Each auxiliary variable is defined by the first triplet that names
+    // it, so the triplets evaluate in order under any assignment of 1..6
+    EXPECT_EQ(formula.num_variables(), 6u);
+    int max_var = 6;
+    for (const auto& [x, y, z] : formula.get_triplets()) {
+        max_var = std::max({max_var, std::abs(x), std::abs(y), std::abs(z)});
+    }
+    for (int bits = 0; bits < 64; ++bits) {
+        std::vector<int> value(max_var + 1, -1);
+        for (int v = 1; v <= 6; ++v) {
+            value[v] = (bits >> (v - 1)) & 1;
+        }
+        auto holds = [&value](int lit) { return value[std::abs(lit)] == (lit > 0 ? 1 : 0); };
+        bool clauses_hold = std::all_of(clauses.begin(), clauses.end(), [&](const std::vector<int>& clause) {
+            return std::any_of(clause.begin(), clause.end(), holds);
+        });
+        bool triplets_hold = true;
+        for (const auto& [x, y, z] : formula.get_triplets()) {
+            bool implication = !holds(y) || holds(z);
+            if (value[std::abs(x)] < 0) {
+                value[std::abs(x)] = implication == (x > 0) ? 1 : 0;
+            }
+            triplets_hold &= holds(x) == implication;
+        }
+        EXPECT_EQ(clauses_hold, triplets_hold) << "assignment " << bits;
+    }
+}
+
+TEST(FormulaTests, RecoverGatesKeepsModelLength) {
+    // Auxiliary variables are not problem variables, so models cover
+    // exactly the variables of the clauses
+    Formula formula;
+    formula.add_clause({1, 2});
+    formula.add_clause({-1});
+    recover_gates(formula);
+    EXPECT_EQ(formula.num_variables(), 2u);
+
+    Solver solver;
+    ASSERT_TRUE(solver.solve(formula));
+    EXPECT_EQ(solver.get_model(), (std::vector<int>{-1, 2}));
+}
+
+TEST(FormulaTests, ClausesAddedAfterEncodingTakeEffect) {
+    Formula formula;
+    formula.add_clause({1, 2});
+    formula.add_clause({-1, 3});
+    formula.get_triplets();
+    formula.add_clause({-2, -3});
+
+    Formula expected;
+    for (const auto& clause : {std::vector<int>{1, 2}, {-1, 3}, {-2, -3}}) {
+        expected.add_clause(clause);
+    }
+    EXPECT_EQ(formula.get_triplets(), expected.get_triplets());
+
+    // A structural formula takes them as triplets; a new problem variable
+    // joins the model
+    Formula structural;
+    structural.add_clause({1, 2});
+    recover_gates(structural);
+    Solver solver;
+    ASSERT_TRUE(solver.solve(structural));
+    structural.add_clause({-1});
+    structural.add_clause({-2, 3});
+    EXPECT_EQ(structural.num_variables(), 3u);
+    ASSERT_TRUE(solver.solve(structural));
+    EXPECT_EQ(solver.get_model(), (std::vector<int>{-1, 2, 3}));
+    structural.add_clause({-3});
+    EXPECT_FALSE(solver.solve(structural));
+}
+
+TEST(FormulaTests, ConcurrentLazyEncoding) {
+    Formula formula;
+    for (int i = 1; i <= 200; ++i) {
+        formula.add_clause({i, -(i + 1), i + 2});
+    }
+    Formula serial;
+    for (const auto& clause : formula.get_clauses()) {
+        serial.add_clause(clause);
+    }
+    const auto& expected = serial.get_triplets();
+
+    // Every thread sees the one encoding, whoever made it
+    const Formula& shared = formula;
+    std::vector<const std::vector<std::tuple<int, int, int>>*> seen(8, nullptr);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < seen.size(); ++t) {
+        threads.emplace_back([&shared, &seen, t] { seen[t] = &shared.get_triplets(); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto* triplets : seen) {
+        EXPECT_EQ(triplets, &formula.get_triplets());
+    }
+    EXPECT_EQ(formula.get_triplets(), expected);
+
+    // Adding a clause to a formula not yet encoded still takes effect
+    Formula empty;
+    EXPECT_TRUE(empty.get_triplets().empty());
+    empty.add_clause({1, 2});
+    empty.add_clause({-1, 2});
+    EXPECT_FALSE(empty.get_triplets().empty());
+}
+
+TEST(FormulaTests, ParallelEncodingMatchesSerial) {
+    std::mt19937 rng(7);
+    Formula serial;
+    Formula parallel;
+    for (int i = 0; i < 5000; ++i) {
+        std::vector<int> clause(1 + rng() % 6);
+        for (int& lit : clause) {
+            lit = static_cast<int>(1 + rng() % 300) * (rng() % 2 ? 1 : -1);
+        }
+        serial.add_clause(clause);
+        parallel.add_clause(clause);
+    }
+    serial.set_encoding_threads(1);
+    serial.encode_to_implication_triplets();
+    for (size_t threads : {2, 3, 8}) {
+        parallel.set_encoding_threads(threads);
+        parallel.encode_to_implication_triplets();
+        EXPECT_EQ(parallel.get_triplets(), serial.get_triplets()) << threads << " threads";
+        EXPECT_EQ(parallel.get_triplet_kind_offsets(), serial.get_triplet_kind_offsets());
+    }
+}
+
+TEST(FormulaTests, StagedEncodingMatchesFull) {
+    std::mt19937 rng(11);
+    Formula full;
+    Formula staged;
+    for (int i = 0; i < 2000; ++i) {
+        std::vector<int> clause(1 + rng() % 5);
+        for (int& lit : clause) {
+            lit = static_cast<int>(1 + rng() % 100) * (rng() % 2 ? 1 : -1);
+        }
+        full.add_clause(clause);
+        staged.add_clause(clause);
+        if (i % 300 == 0) {
+            staged.encode_new_clauses();
+        }
+    }
+    // Clauses added after the last stage are encoded when finishing, and
+    // the representatives account for every variable
+    staged.add_clause({150, -151});
+    full.add_clause({150, -151});
+    EXPECT_EQ(staged.get_triplets(), full.get_triplets());
+    EXPECT_EQ(staged.get_triplet_kind_offsets(), full.get_triplet_kind_offsets());
+}
+
 } // namespace test
 } // namespace stalmarck
\ No newline at end of file
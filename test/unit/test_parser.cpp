@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <fstream>
+#include <random>
 #include "parser/parser.hpp"
 #include "core/formula.hpp"
 
@@ -115,5 +116,198 @@ TEST_F(ParserTests, CommentsOnly) {
     std::remove("comments.cnf");
 }
 
+TEST_F(ParserTests, AigerGatesBecomeTriplets) {
+    // o = x & y in ASCII, and the same circuit in binary
+    std::ofstream ascii("and.aag");
+    ascii << "aag 3 2 0 1 1\n2\n4\n6\n6 2 4\n";
+    ascii.close();
+    std::ofstream binary("and.aig", std::ios::binary);
+    binary << "aig 3 2 0 1 1\n6\n" << '\x02' << '\x02';
+    binary.close();
+
+    for (const char* filename : {"and.aag", "and.aig"}) {
+        Parser parser;
+        Formula formula = parser.parse_file(filename);
+        ASSERT_FALSE(parser.has_error()) << parser.get_error();
+        EXPECT_TRUE(formula.is_structural());
+        EXPECT_EQ(formula.num_variables(), 3);
+        EXPECT_EQ(formula.num_clauses(), 0);
+
+        // -3 <-> (1 -> -2), and the output asserted as (3, 3, 3)
+        const auto& triplets = formula.get_triplets();
+        ASSERT_EQ(triplets.size(), 2);
+        EXPECT_EQ(triplets[0], std::make_tuple(-3, 1, -2));
+        EXPECT_EQ(triplets[1], std::make_tuple(3, 3, 3));
+    }
+    std::remove("and.aag");
+    std::remove("and.aig");
+}
+
+TEST_F(ParserTests, AigerHashesAndFoldsGates) {
+    // y & x duplicates x & y; input 6 is outside the output's cone but keeps
+    // its variable
+    std::ofstream shared("shared.aag");
+    shared << "aag 5 3 0 1 2\n2\n4\n6\n9\n8 2 4\n10 4 2\n";
+    shared.close();
+    // x & -x is constant false, so the output can never be 1
+    std::ofstream constant("constant.aag");
+    constant << "aag 2 1 0 1 1\n2\n4\n4 2 3\n";
+    constant.close();
+
+    Parser parser;
+    Formula formula = parser.parse_file("shared.aag");
+    ASSERT_FALSE(parser.has_error()) << parser.get_error();
+    EXPECT_EQ(formula.num_variables(), 4);
+    EXPECT_EQ(formula.get_triplets().size(), 2);
+
+    formula = parser.parse_file("constant.aag");
+    ASSERT_FALSE(parser.has_error()) << parser.get_error();
+    const auto& triplets = formula.get_triplets();
+    ASSERT_EQ(triplets.size(), 2);
+    EXPECT_EQ(triplets[0], std::make_tuple(2, 2, 2));
+    EXPECT_EQ(triplets[1], std::make_tuple(-2, -2, -2));
+
+    std::remove("shared.aag");
+    std::remove("constant.aag");
+}
+
+TEST_F(ParserTests, AigerKeepsInputNumbers) {
+    // o = y & z; x is outside the output's cone but stays variable 1
+    std::ofstream unused("unused.aag");
+    unused << "aag 4 3 0 1 1\n2\n4\n6\n8\n8 4 6\n";
+    unused.close();
+
+    Parser parser;
+    Formula formula = parser.parse_file("unused.aag");
+    ASSERT_FALSE(parser.has_error()) << parser.get_error();
+    EXPECT_EQ(formula.num_variables(), 4);
+    const auto& triplets = formula.get_triplets();
+    ASSERT_EQ(triplets.size(), 2);
+    EXPECT_EQ(triplets[0], std::make_tuple(-4, 2, -3));
+    EXPECT_EQ(triplets[1], std::make_tuple(4, 4, 4));
+
+    std::remove("unused.aag");
+}
+
+TEST_F(ParserTests, InvalidAiger) {
+    std::ofstream range("range.aag");
+    range << "aag 3 2 0 1 1\n2\n4\n6\n6 8 4\n";
+    range.close();
+    std::ofstream cycle("cycle.aag");
+    cycle << "aag 3 1 0 1 2\n2\n4\n4 6 2\n6 4 2\n";
+    cycle.close();
+
+    Parser parser;
+    Formula formula = parser.parse_file("range.aag");
+    EXPECT_TRUE(parser.has_error());
+    EXPECT_EQ(parser.get_error(), "AIGER literal exceeds declared maximum: 8");
+    EXPECT_EQ(formula.num_variables(), 0);
+
+    parser.parse_file("cycle.aag");
+    EXPECT_TRUE(parser.has_error());
+    EXPECT_EQ(parser.get_error(), "AIGER gates form a cycle");
+
+    std::remove("range.aag");
+    std::remove("cycle.aag");
+}
+
+TEST_F(ParserTests, ExpressionBecomesSharedTriplets) {
+    Parser parser;
+    // b & a is a & b again, and the let binding is shared, not copied
+    Formula formula = parser.parse_expression_string(
+        "# comment\n"
+        "let both = a & b;\n"
+        "(both -> c) & (b ∧ a -> ¬c) & both\n");
+    ASSERT_FALSE(parser.has_error()) << parser.get_error();
+    EXPECT_TRUE(formula.is_structural());
+    EXPECT_EQ(parser.atom_names(), (std::vector<std::string>{"a", "b", "c"}));
+
+    // a & b, both -> c, both -> !c, two conjunctions and the assertion
+    EXPECT_EQ(formula.num_variables(), 3 + 5);
+    EXPECT_EQ(formula.get_triplets().size(), 6);
+
+    // Negation only changes the assertion
+    Formula negated = parser.parse_expression_string("let both = a & b;\n(both -> c) & (b ∧ a -> ¬c) & both\n", true);
+    ASSERT_FALSE(parser.has_error());
+    EXPECT_EQ(negated.get_triplets().size(), formula.get_triplets().size());
+
+    // Constants fold away
+    formula = parser.parse_expression_string("p | !p");
+    ASSERT_FALSE(parser.has_error());
+    EXPECT_EQ(formula.num_variables(), 0);
+    EXPECT_TRUE(formula.get_triplets().empty());
+}
+
+TEST_F(ParserTests, InvalidExpression) {
+    Parser parser;
+    parser.parse_expression_string("a &\n(b | )");
+    EXPECT_TRUE(parser.has_error());
+    EXPECT_EQ(parser.get_error(), "Expected a formula on line 2");
+
+    parser.parse_expression_string("let a = b; let a = c; a");
+    EXPECT_TRUE(parser.has_error());
+    EXPECT_EQ(parser.get_error(), "Name already in use: a on line 1");
+
+    parser.parse_expression_string(std::string(2000, '(') + "a" + std::string(2000, ')'));
+    EXPECT_TRUE(parser.has_error());
+    EXPECT_EQ(parser.get_error(), "Formula nested too deeply on line 1");
+}
+
+TEST_F(ParserTests, XorLines) {
+    Parser parser;
+    Formula formula = parser.parse_dimacs_string("p cnf 4 1\n"
+                                                 "1 2 0\n"
+                                                 "x1 -2 3 0\n"
+                                                 "x 4 2 4 0\n");
+    ASSERT_FALSE(parser.has_error());
+    EXPECT_EQ(formula.num_clauses(), 1u);
+    ASSERT_EQ(formula.get_xors().size(), 2u);
+
+    // A negated literal flips the parity; a repeated variable cancels
+    EXPECT_EQ(formula.get_xors()[0].variables, (std::vector<int>{1, 2, 3}));
+    EXPECT_FALSE(formula.get_xors()[0].rhs);
+    EXPECT_EQ(formula.get_xors()[1].variables, (std::vector<int>{2}));
+    EXPECT_TRUE(formula.get_xors()[1].rhs);
+
+    parser.parse_dimacs_string("p cnf 2 0\nx1 3 0\n");
+    EXPECT_TRUE(parser.has_error());
+}
+
+TEST_F(ParserTests, PipelinedMatchesSerial) {
+    // Over a megabyte, so lines straddle the pipeline's blocks, ending
+    // without a newline
+    std::mt19937 rng(3);
+    std::ofstream large("large.cnf");
+    large << "c generated\np cnf 5000 100000\n";
+    for (int i = 0; i < 100000; ++i) {
+        if (i % 1000 == 0) {
+            large << "x" << 1 + rng() % 5000 << " -" << 1 + rng() % 5000 << " 0\n";
+        }
+        for (int j = 0; j < 3; ++j) {
+            large << (rng() % 2 ? "-" : "") << 1 + rng() % 5000 << " ";
+        }
+        large << (i + 1 < 100000 ? "0\n" : "0");
+    }
+    large.close();
+
+    Parser serial;
+    Parser pipelined;
+    pipelined.set_pipelined(true);
+    Formula expected = serial.parse_dimacs("large.cnf");
+    Formula formula = pipelined.parse_dimacs("large.cnf");
+    ASSERT_FALSE(pipelined.has_error());
+    EXPECT_EQ(formula.num_variables(), expected.num_variables());
+    EXPECT_EQ(formula.get_clauses(), expected.get_clauses());
+    ASSERT_EQ(formula.get_xors().size(), expected.get_xors().size());
+    EXPECT_EQ(formula.get_xors().back().variables, expected.get_xors().back().variables);
+    EXPECT_EQ(formula.get_triplets(), expected.get_triplets());
+    std::remove("large.cnf");
+
+    formula = pipelined.parse_dimacs("invalid_var.cnf");
+    EXPECT_TRUE(pipelined.has_error());
+    EXPECT_EQ(pipelined.get_error(), "Variable number exceeds declared maximum");
+    EXPECT_EQ(formula.num_clauses(), 0);
+}
+
 } // namespace test
 } // namespace stalmarck
\ No newline at end of file
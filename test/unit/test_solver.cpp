@@ -1,6 +1,19 @@
 #include <gtest/gtest.h>
 #include "solver/solver.hpp"
 #include "core/formula.hpp"
+#include "solver/lookahead.hpp"
+#include "solver/inprocess.hpp"
+#include "solver/assignment.hpp"
+#include "solver/symmetry.hpp"
+#include "solver/gauss.hpp"
+#include "solver/rules.hpp"
+#include "solver/local_search.hpp"
+#include "core/trace.hpp"
+#include "core/gates.hpp"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <sstream>
 
 namespace stalmarck {
 namespace test {
@@ -110,6 +123,42 @@ TEST(SolverTests, rule7Basic) {
     EXPECT_FALSE(solver.has_contradiction());
 }
 
+// Test that rules needing a literal true accept it when it already holds,
+// whatever its sign, and fail when it is already false (rules 1, 2, 4, 5, 7)
+TEST(SolverTests, RulesTestLiteralValuesNotSigns) {
+    auto apply = [](std::tuple<int, int, int> triplet, std::vector<int> true_literals, bool& changed) {
+        std::vector<int8_t> base(5, 0);
+        std::vector<int8_t> overlay(5, 0);
+        std::vector<int> touched;
+        for (int lit : true_literals) {
+            base[std::abs(lit)] = lit > 0 ? 1 : -1;
+        }
+        rules::OverlayView view{base.data(), overlay.data(), &touched};
+        changed = false;
+        return rules::sweep_unsorted(view, {triplet}, changed);
+    };
+    struct Case {
+        const char* rule;
+        std::tuple<int, int, int> triplet;
+        std::vector<int> holds;     // the rule's conclusion already holds
+        std::vector<int> conflicts; // a literal of the conclusion already false
+    };
+    const Case cases[] = {
+        {"1: (0,y,z) => y=1, z=0", {-1, -2, -3}, {1, -2, 3}, {1, 2, 3}},
+        {"1: (0,y,z) => y=1, z=0", {-1, -2, -3}, {1, -2, 3}, {1, -2, -3}},
+        {"2: (x,0,z) => x=1", {-1, -2, 4}, {-1, 2}, {1, 2}},
+        {"4: (x,y,y) => x=1", {-1, 2, 2}, {-1}, {1}},
+        {"5: (x,y,1) => x=1", {-1, 4, -3}, {-1, -3}, {1, -3}},
+        {"7: (x,x,z) => x=1, z=1", {-1, -1, -3}, {-1, -3}, {-1, 3}},
+    };
+    for (const auto& c : cases) {
+        bool changed = true;
+        EXPECT_TRUE(apply(c.triplet, c.holds, changed)) << "rule " << c.rule;
+        EXPECT_FALSE(changed) << "rule " << c.rule;
+        EXPECT_FALSE(apply(c.triplet, c.conflicts, changed)) << "rule " << c.rule;
+    }
+}
+
 // Test multiple rules combined
 TEST(SolverTests, multipleRulesCombined) {
     Solver solver;
@@ -253,5 +302,565 @@ TEST(SolverTests, MultipleSatisfiableAssignments) {
     EXPECT_TRUE(solver.has_complete_assignment());
 }
 
+// Test that the model covers every problem variable
+TEST(SolverTests, ModelAfterSatisfiableSolve) {
+    Solver solver;
+    Formula formula;
+
+    formula.add_clause({1, 2});
+    formula.add_clause({-1, 3});
+
+    ASSERT_TRUE(solver.solve(formula));
+    const auto& model = solver.get_model();
+    ASSERT_EQ(model.size(), formula.num_variables());
+    for (size_t i = 0; i < model.size(); ++i) {
+        EXPECT_EQ(std::abs(model[i]), static_cast<int>(i + 1));
+    }
+}
+
+// Test that assumptions restrict a single solve and then go away
+TEST(SolverTests, AssumptionsAreScopedToOneSolve) {
+    Solver solver;
+    Formula formula;
+    formula.add_clause({1, 2});
+    formula.add_clause({-1, 3});
+
+    ASSERT_TRUE(solver.solve(formula, {1, 3}));
+    EXPECT_EQ(1, solver.get_model()[0]);
+    EXPECT_EQ(3, solver.get_model()[2]);
+    EXPECT_GT(solver.get_stats().propagations, 0u);
+
+    // Contradictory assumptions fail immediately
+    EXPECT_FALSE(solver.solve(formula, {2, -2}));
+
+    ASSERT_TRUE(solver.solve(formula, {-1, 2}));
+    EXPECT_EQ(-1, solver.get_model()[0]);
+    EXPECT_EQ(2, solver.get_model()[1]);
+}
+
+// Test that an exhausted time budget stops the search
+TEST(SolverTests, TimeoutInterruptsSearch) {
+    Solver solver;
+    Formula formula;
+
+    // Pigeonhole with 7 pigeons and 6 holes is far beyond a 50ms budget
+    const int holes = 6;
+    auto var = [holes](int pigeon, int hole) { return pigeon * holes + hole + 1; };
+    for (int p = 0; p <= holes; ++p) {
+        std::vector<int> clause;
+        for (int h = 0; h < holes; ++h) {
+            clause.push_back(var(p, h));
+        }
+        formula.add_clause(clause);
+    }
+    for (int h = 0; h < holes; ++h) {
+        for (int p = 0; p <= holes; ++p) {
+            for (int q = p + 1; q <= holes; ++q) {
+                formula.add_clause({-var(p, h), -var(q, h)});
+            }
+        }
+    }
+
+    solver.set_timeout(0.05);
+    EXPECT_FALSE(solver.solve(formula));
+    EXPECT_TRUE(solver.is_interrupted());
+}
+
+// Test that probing counts implications and reports failed literals
+TEST(SolverTests, LookaheadProbe) {
+    // 1 = false forces 2 = true, 3 = false, which the second triplet refutes
+    std::vector<std::tuple<int, int, int>> triplets = {{1, 2, 3}, {-2, 3, 9}, {4, 5, 6}};
+    std::vector<int8_t> values(10, 0);
+
+    Lookahead lookahead(2);
+    const auto& results = lookahead.probe(triplets, nullptr, values.data(), values.size(), {1, 4});
+    ASSERT_EQ(2u, results.size());
+    EXPECT_EQ(1, results[0].variable);
+    EXPECT_FALSE(results[0].true_failed);
+    EXPECT_TRUE(results[0].false_failed);
+    EXPECT_FALSE(results[1].true_failed);
+    EXPECT_FALSE(results[1].false_failed);
+    EXPECT_EQ(2u, results[1].false_implied);
+
+    // Probing never writes to the shared assignment
+    EXPECT_EQ(std::vector<int8_t>(10, 0), values);
+    EXPECT_EQ(4, Lookahead::best_split(results));
+}
+
+// Small instances with known answers
+struct KnownInstance {
+    std::vector<std::vector<int>> clauses;
+    bool satisfiable;
+};
+
+const std::vector<KnownInstance> known_instances = {
+    {{{1, 2}, {-1, 2}, {1, -2}, {-1, -2}}, false},
+    {{{1, 2}, {1, -2}, {-1, 3}, {-1, -3}}, false},
+    {{{1, 2, 3}, {-1, -2}, {-2, -3}, {2, -3}}, true},
+    {{{1, -2}, {2, -3}, {3, -4}, {4, -1}, {1, 3}}, true},
+};
+
+// Built through recovered gates, which the solver answers exactly
+Formula known_formula(const KnownInstance& instance) {
+    Formula formula;
+    for (const auto& clause : instance.clauses) {
+        formula.add_clause(clause);
+    }
+    recover_gates(formula);
+    return formula;
+}
+
+// Check an answer against the known status, and its model against every clause
+void expect_known_answer(const KnownInstance& instance, const Formula& formula, Solver& solver) {
+    bool result = solver.solve(formula);
+    EXPECT_EQ(instance.satisfiable, result);
+    if (!result) {
+        return;
+    }
+    const auto& model = solver.get_model();
+    ASSERT_EQ(formula.num_variables(), model.size());
+    for (const auto& clause : instance.clauses) {
+        EXPECT_TRUE(std::any_of(clause.begin(), clause.end(), [&](int lit) {
+            return model[std::abs(lit) - 1] == lit;
+        }));
+    }
+}
+
+// Test that lookahead splits give the known answers and valid models
+TEST(SolverTests, LookaheadGivesKnownAnswers) {
+    for (const auto& instance : known_instances) {
+        Formula formula = known_formula(instance);
+        Solver probing;
+        probing.set_lookahead(4, 2);
+        expect_known_answer(instance, formula, probing);
+    }
+}
+
+// Test that equivalent literals are found and substituted away
+TEST(SolverTests, EquivalentLiteralSubstitution) {
+    // Each triplet (x,y,z) carries z -> x, so these make 1 and 2 equivalent
+    std::vector<std::tuple<int, int, int>> triplets = {{1, 5, 2}, {2, 6, 1}, {-2, 3, 4}, {-1, 3, 4}};
+    std::vector<int> representative;
+    ASSERT_TRUE(find_equivalent_literals(triplets, 6, representative));
+    EXPECT_EQ(1, representative[1]);
+    EXPECT_EQ(1, representative[2]);
+    EXPECT_EQ(3, representative[3]);
+
+    EXPECT_EQ(1u, substitute_equivalent_literals(triplets, representative));
+    std::vector<std::tuple<int, int, int>> expected = {{1, 5, 1}, {1, 6, 1}, {-1, 3, 4}};
+    EXPECT_EQ(expected, triplets);
+
+    // A literal equivalent to its negation is a contradiction
+    std::vector<std::tuple<int, int, int>> contradictory = {{1, 5, -1}, {-1, 6, 1}};
+    EXPECT_FALSE(find_equivalent_literals(contradictory, 6, representative));
+}
+
+// Test that probing finds failed literals and literals both polarities imply
+TEST(SolverTests, FailedLiteralProbing) {
+    // 1 = false forces 2 = true, 3 = false, which the second triplet refutes
+    std::vector<std::tuple<int, int, int>> triplets = {{1, 2, 3}, {-2, 3, 9}};
+    std::vector<int8_t> values(10, 0);
+    std::vector<int> units;
+    ASSERT_TRUE(probe_failed_literals(triplets, nullptr, values.data(), values.size(), {1}, 1, units));
+    EXPECT_EQ((std::vector<int>{1}), units);
+
+    // Reused scratch comes back clean, also when both polarities fail
+    ProbeScratch scratch;
+    std::vector<std::tuple<int, int, int>> both_fail = {{1, 5, 6}, {-1, 5, 6}};
+    units.clear();
+    EXPECT_FALSE(probe_failed_literals(both_fail, nullptr, values.data(), values.size(), {1}, 1, units, scratch));
+    EXPECT_EQ(std::vector<int8_t>(10, 0), scratch.overlay);
+    EXPECT_EQ(std::vector<int8_t>(10, 0), scratch.first);
+    units.clear();
+    ASSERT_TRUE(probe_failed_literals(triplets, nullptr, values.data(), values.size(), {1}, 1, units, scratch));
+    EXPECT_EQ((std::vector<int>{1}), units);
+    EXPECT_EQ(std::vector<int8_t>(10, 0), scratch.overlay);
+}
+
+// Test that inprocessing gives the known answers and valid models
+TEST(SolverTests, InprocessingGivesKnownAnswers) {
+    for (const auto& instance : known_instances) {
+        Formula formula = known_formula(instance);
+        Solver simplifying;
+        simplifying.set_inprocessing(true);
+        expect_known_answer(instance, formula, simplifying);
+    }
+}
+
+TEST(SolverTests, PackedAssignment) {
+    std::vector<uint64_t> words(PackedAssignment::words_for(70));
+    PackedAssignment assignment;
+    assignment.attach(words.data(), 70);
+    EXPECT_EQ(assignment.num_words(), 3u);
+
+    // Neighbours in the same word and across a word boundary
+    assignment.set(31, 1);
+    assignment.set(32, -1);
+    assignment.set(69, 1);
+    EXPECT_EQ(assignment.value(30), 0);
+    EXPECT_EQ(assignment.value(31), 1);
+    EXPECT_EQ(assignment.value(32), -1);
+    EXPECT_EQ(assignment.value(69), 1);
+    assignment.set(32, 1);
+    EXPECT_EQ(assignment.value(32), 1);
+    assignment.set(31, 0);
+    EXPECT_EQ(assignment.value(31), 0);
+
+    std::vector<uint64_t> saved(assignment.num_words());
+    assignment.save(saved.data());
+    std::vector<int8_t> dense(70);
+    assignment.unpack(dense.data(), dense.size());
+    EXPECT_EQ(dense[32], 1);
+    EXPECT_EQ(dense[69], 1);
+
+    assignment.clear();
+    EXPECT_EQ(assignment.value(69), 0);
+    assignment.attach(saved.data(), 70);
+    EXPECT_EQ(assignment.value(69), 1);
+}
+
+// Test that compact mode gives the known answers, and searches exactly as
+// the dense assignment does
+TEST(SolverTests, CompactModeGivesKnownAnswers) {
+    for (const auto& instance : known_instances) {
+        Formula formula = known_formula(instance);
+        Solver compact;
+        compact.set_compact(true);
+        expect_known_answer(instance, formula, compact);
+
+        Solver dense;
+        dense.solve(formula);
+        EXPECT_EQ(dense.get_model(), compact.get_model());
+        EXPECT_EQ(dense.get_stats().propagations, compact.get_stats().propagations);
+    }
+}
+
+// p pigeons in h holes; variable p*h+h+1 puts pigeon p in hole h
+Formula pigeonhole(int pigeons, int holes) {
+    Formula formula;
+    auto var = [holes](int p, int h) { return p * holes + h + 1; };
+    for (int p = 0; p < pigeons; ++p) {
+        std::vector<int> clause;
+        for (int h = 0; h < holes; ++h) {
+            clause.push_back(var(p, h));
+        }
+        formula.add_clause(clause);
+    }
+    for (int h = 0; h < holes; ++h) {
+        for (int p = 0; p < pigeons; ++p) {
+            for (int q = p + 1; q < pigeons; ++q) {
+                formula.add_clause({-var(p, h), -var(q, h)});
+            }
+        }
+    }
+    return formula;
+}
+
+TEST(SolverTests, SymmetriesMapClausesOntoClauses) {
+    Formula formula = pigeonhole(3, 2);
+    std::vector<Symmetry> generators = find_symmetries(formula);
+    ASSERT_FALSE(generators.empty());
+
+    std::set<std::vector<int>> clauses;
+    for (auto clause : formula.get_clauses()) {
+        std::sort(clause.begin(), clause.end());
+        clauses.insert(clause);
+    }
+    for (const Symmetry& symmetry : generators) {
+        ASSERT_EQ(symmetry.size(), formula.num_variables() + 1);
+        for (const auto& clause : clauses) {
+            std::vector<int> mapped;
+            for (int lit : clause) {
+                mapped.push_back(lit > 0 ? symmetry[lit] : -symmetry[-lit]);
+            }
+            std::sort(mapped.begin(), mapped.end());
+            EXPECT_EQ(clauses.count(mapped), 1u);
+        }
+    }
+
+    // No symmetry in an asymmetric chain
+    Formula chain;
+    chain.add_clause({1, 2});
+    chain.add_clause({-2, 3});
+    chain.add_clause({-3, -1, 2});
+    EXPECT_TRUE(find_symmetries(chain).empty());
+}
+
+TEST(SolverTests, SymmetryBreakingPrunesPigeonhole) {
+    SymmetryOptions single;
+    single.max_prefix = 1;
+    Formula plain = pigeonhole(4, 3);
+    Formula broken = pigeonhole(4, 3);
+    EXPECT_GT(break_symmetries(broken, single), 0u);
+    EXPECT_GT(broken.num_clauses(), plain.num_clauses());
+
+    // Solved through recovered gates, where the search is not dominated by
+    // the clause encoding
+    recover_gates(plain);
+    recover_gates(broken);
+    Solver plain_solver;
+    Solver broken_solver;
+    EXPECT_FALSE(plain_solver.solve(plain));
+    EXPECT_FALSE(broken_solver.solve(broken));
+    EXPECT_LT(broken_solver.get_stats().decisions, plain_solver.get_stats().decisions);
+
+    // Each satisfiable instance keeps some of its models; checked by
+    // enumeration, as the clauses added here need no auxiliary variables
+    Formula satisfiable = pigeonhole(3, 3);
+    auto count_models = [](const Formula& formula) {
+        size_t n = formula.num_variables();
+        size_t models = 0;
+        for (uint32_t bits = 0; bits < (1u << n); ++bits) {
+            models += std::all_of(formula.get_clauses().begin(), formula.get_clauses().end(), [&](const auto& clause) {
+                return std::any_of(clause.begin(), clause.end(), [&](int lit) {
+                    return ((bits >> (std::abs(lit) - 1)) & 1) == (lit > 0 ? 1u : 0u);
+                });
+            });
+        }
+        return models;
+    };
+    size_t before = count_models(satisfiable);
+    break_symmetries(satisfiable, single);
+    ASSERT_EQ(satisfiable.num_variables(), 9u);
+    size_t after = count_models(satisfiable);
+    EXPECT_GT(after, 0u);
+    EXPECT_LT(after, before);
+}
+
+TEST(SolverTests, SymmetryBreakingWholeChainsPruneMore) {
+    // Once gates are recovered, whole lex-leader chains cut the search
+    // below what one-variable chains leave
+    auto decisions = [](size_t max_prefix) {
+        Formula formula = pigeonhole(5, 4);
+        SymmetryOptions options;
+        options.max_prefix = max_prefix;
+        break_symmetries(formula, options);
+        recover_gates(formula);
+        Solver solver;
+        EXPECT_FALSE(solver.solve(formula));
+        return solver.get_stats().decisions;
+    };
+    EXPECT_LT(decisions(SymmetryOptions().max_prefix), decisions(1));
+}
+
+TEST(SolverTests, GaussEliminationDecidesParity) {
+    // x1 ^ x2 ^ x3 = 1, x2 ^ x3 ^ x4 = 1 and x1 ^ x4 = 1 sum to 0 = 1
+    Formula contradictory;
+    contradictory.add_xor({1, 2, 3});
+    contradictory.add_xor({2, 3, 4});
+    contradictory.add_xor({1, 4});
+    Solver solver;
+    EXPECT_FALSE(solver.solve(contradictory));
+    EXPECT_EQ(solver.get_stats().decisions, 0u);
+
+    // x1 and a chain x_i ^ x_i+1 = 1: elimination forces every value
+    Formula chain;
+    chain.add_xor({1});
+    for (int v = 1; v < 20; ++v) {
+        chain.add_xor({v, v + 1});
+    }
+    ASSERT_TRUE(solver.solve(chain));
+    EXPECT_EQ(solver.get_stats().decisions, 0u);
+    EXPECT_EQ(solver.get_stats().xor_propagations, 20u);
+    const auto& model = solver.get_model();
+    ASSERT_EQ(model.size(), 20u);
+    for (int v = 1; v <= 20; ++v) {
+        EXPECT_EQ(model[v - 1], v % 2 == 1 ? v : -v);
+    }
+}
+
+TEST(SolverTests, ExtractXorsFromClauses) {
+    // x1 ^ x2 ^ x3 = 0: the clauses with an odd number of negations
+    Formula formula;
+    formula.add_clause({-1, 2, 3});
+    formula.add_clause({1, -2, 3});
+    formula.add_clause({1, 2, -3});
+    formula.add_clause({-1, -2, -3});
+    formula.add_clause({1, 2, 3, 4}); // no complete parity pattern
+    EXPECT_EQ(extract_xors(formula), 1u);
+    ASSERT_EQ(formula.get_xors().size(), 1u);
+    EXPECT_EQ(formula.get_xors()[0].variables, (std::vector<int>{1, 2, 3}));
+    EXPECT_FALSE(formula.get_xors()[0].rhs);
+    EXPECT_EQ(formula.num_clauses(), 5u);
+
+    GaussElimination gauss;
+    EXPECT_TRUE(gauss.init(formula.get_xors()));
+    EXPECT_EQ(gauss.num_rows(), 1u);
+}
+
+TEST(SolverTests, TraceRecordsSolvePhases) {
+    Formula formula;
+    formula.add_clause({1, 2});
+    formula.add_clause({-1, 3});
+    formula.add_clause({-2, -3});
+
+    start_trace();
+    set_trace_thread_name("test \"main\"");
+    Solver solver;
+    solver.solve(formula);
+    stop_trace();
+    { TraceSpan ignored("after stop"); }
+
+    std::ostringstream out;
+    write_trace(out);
+    std::string json = out.str();
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"solve\", \"ph\": \"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"propagate\""), std::string::npos);
+    EXPECT_NE(json.find("test \\\"main\\\""), std::string::npos);
+    EXPECT_EQ(json.find("after stop"), std::string::npos);
+
+    // A full ring keeps the latest events: the solve span ends last
+    start_trace(2);
+    solver.solve(formula);
+    stop_trace();
+    out.str("");
+    write_trace(out);
+    json = out.str();
+    size_t events = 0;
+    for (size_t pos = json.find("\"ph\": \"X\""); pos != std::string::npos;
+         pos = json.find("\"ph\": \"X\"", pos + 1)) {
+        events++;
+    }
+    EXPECT_EQ(events, 2u);
+    EXPECT_NE(json.find("\"name\": \"solve\""), std::string::npos);
+}
+
+TEST(SolverTests, PhaseCountersSplitTheSolve) {
+    Formula formula;
+    formula.add_clause({1, 2, 3});
+    formula.add_clause({-1, -2});
+    formula.add_clause({-2, -3});
+    formula.add_clause({-1, -3});
+
+    // Off by default: nothing measured
+    Solver solver;
+    ASSERT_TRUE(solver.solve(formula));
+    EXPECT_EQ(solver.get_stats().search_phase.seconds, 0.0);
+
+    // Without a PMU (containers, CI) the counts stay -1 and only time is kept
+    solver.set_phase_counters(true);
+    ASSERT_TRUE(solver.solve(formula));
+    const SolverStats& stats = solver.get_stats();
+    for (const PhaseCounters* phase : {&stats.propagation_phase, &stats.search_phase}) {
+        EXPECT_GE(phase->seconds, 0.0);
+        for (int64_t count : {phase->cycles, phase->instructions, phase->l1d_misses,
+                              phase->llc_misses, phase->branch_misses}) {
+            EXPECT_GE(count, -1);
+        }
+    }
+    EXPECT_LE(stats.propagation_phase.seconds + stats.search_phase.seconds, stats.solve_time + 1e-3);
+
+    PhaseCounters before;
+    before.seconds = 1.0;
+    before.cycles = 100;
+    PhaseCounters after;
+    after.seconds = 3.0;
+    after.cycles = 250;
+    after.instructions = 40;
+    PhaseCounters phase = phase_difference(after, before);
+    EXPECT_DOUBLE_EQ(phase.seconds, 2.0);
+    EXPECT_EQ(phase.cycles, 150);
+    EXPECT_EQ(phase.instructions, -1);
+}
+
+TEST(SolverTests, LocalSearchSolvesPlantedInstance) {
+    // Random 3-SAT at ratio 4 with a planted model: too big for the
+    // complete search, quick for local search
+    const int n = 2000;
+    std::mt19937 random(7);
+    std::vector<bool> planted(n + 1);
+    for (int var = 1; var <= n; ++var) {
+        planted[var] = random() & 1;
+    }
+    Formula formula;
+    while (formula.num_clauses() < 4u * n) {
+        std::vector<int> clause;
+        bool satisfied = false;
+        for (int i = 0; i < 3; ++i) {
+            int var = static_cast<int>(random() % n) + 1;
+            int lit = random() & 1 ? var : -var;
+            satisfied |= (lit > 0) == planted[var];
+            clause.push_back(lit);
+        }
+        if (satisfied) {
+            formula.add_clause(clause);
+        }
+    }
+
+    LocalSearch search;
+    search.set_max_flips(10000000);
+    ASSERT_TRUE(search.solve(formula));
+    EXPECT_EQ(search.best_unsatisfied(), 0u);
+    const auto& model = search.get_model();
+    ASSERT_EQ(model.size(), static_cast<size_t>(n));
+    for (const auto& clause : formula.get_clauses()) {
+        bool satisfied = false;
+        for (int lit : clause) {
+            satisfied |= model[std::abs(lit) - 1] == lit;
+        }
+        ASSERT_TRUE(satisfied);
+    }
+}
+
+TEST(SolverTests, LocalSearchGivesUpOnUnsat) {
+    Formula formula;
+    formula.add_clause({1, 2});
+    formula.add_clause({1, -2});
+    formula.add_clause({-1, 2});
+    formula.add_clause({-1, -2});
+    formula.add_clause({3, 3, -4});
+    formula.add_clause({4, -4});
+
+    LocalSearch search;
+    search.set_max_flips(1000);
+    EXPECT_FALSE(search.solve(formula));
+    EXPECT_EQ(search.flips(), 1000u);
+    EXPECT_EQ(search.best_unsatisfied(), 1u);
+    EXPECT_EQ(search.get_best_assignment().size(), 4u);
+    EXPECT_TRUE(search.get_model().empty());
+
+    // A model of the clauses must satisfy the XOR constraints too
+    Formula parity;
+    parity.add_clause({1});
+    parity.add_clause({1, 2});
+    parity.add_xor({-1});
+    search.set_max_flips(0);
+    EXPECT_FALSE(search.solve(parity));
+    EXPECT_EQ(search.best_unsatisfied(), 0u);
+}
+
+TEST(SolverTests, PhaseHintsOverridePhase) {
+    Formula formula;
+    formula.add_clause({1, 2, 3});
+    formula.add_clause({-1, -2});
+    formula.add_clause({-2, -3});
+    formula.add_clause({2, 4});
+    size_t num_variables = formula.num_variables() + formula.get_triplets().size() + 2;
+
+    // Hinting every variable false splits exactly as the false phase does
+    Solver false_first;
+    false_first.set_phase(false);
+    bool result = false_first.solve(formula);
+
+    std::vector<int> all_false;
+    for (size_t var = 1; var <= num_variables; ++var) {
+        all_false.push_back(-static_cast<int>(var));
+    }
+    Solver hinted;
+    hinted.set_phase_hints(all_false);
+    EXPECT_EQ(hinted.solve(formula), result);
+    EXPECT_EQ(hinted.get_model(), false_first.get_model());
+    EXPECT_EQ(hinted.get_stats().decisions, false_first.get_stats().decisions);
+
+    // Cleared hints fall back to the phase
+    Solver plain;
+    result = plain.solve(formula);
+    hinted.set_phase_hints({});
+    EXPECT_EQ(hinted.solve(formula), result);
+    EXPECT_EQ(hinted.get_model(), plain.get_model());
+    EXPECT_EQ(hinted.get_stats().decisions, plain.get_stats().decisions);
+}
+
 } // namespace test
-} // namespace stalmarck
\ No newline at end of file
+} // namespace stalmarck